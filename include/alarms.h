@@ -0,0 +1,85 @@
+#ifndef ALARMS_H
+#define ALARMS_H
+
+#include <stdint.h>
+
+#include "timer.h"
+
+/**
+ * @brief The Alarm class is a DeadlineTimer that calls back when it expires,
+ * instead of being polled.
+ *
+ * restart() starts the countdown of deadline milliseconds, Alarms then calls
+ * fire once it is over. It stays expired until restarted, or until its
+ * deadline moves past the time elapsed, however long it waits: millis()
+ * rolling over does not bring it back.
+ */
+class Alarm
+{
+public:
+    typedef void (*Callback)();
+
+    constexpr Alarm(Callback fire) : fire(fire) {}
+
+    void restart();
+
+    void setDeadline(unsigned long z);
+    void setDeadline(unsigned int m,
+                     unsigned int s,
+                     unsigned long z = 0);
+
+    unsigned long remainingTime() const;
+    void remainingTime(unsigned int& m,
+                       unsigned int& s) const;
+
+    bool hasExpired() const;
+
+    unsigned long  deadline = 0;
+    const Callback fire;
+
+private:
+    friend class Alarms;
+
+    uint32_t      elapsedTime() const;
+    unsigned long timeLeft() const;
+
+    Alarm*        _next    = nullptr;
+    uint32_t      _start   = 0; /**< millis() is 32 bit on the board, here too */
+    bool          _pending = false;
+};
+
+
+
+// =============================================================================
+
+
+
+/**
+ * @brief The Alarms class keeps the pending alarms and fires them when due.
+ *
+ * They are kept in a list sorted by what remains before they expire, the
+ * next one first. The main loop only ever checks that one, so update() costs
+ * a single millis() whatever the number of alarms, and each alarm due is
+ * fired in constant time. Inserting walks the list, there are only a few
+ * alarms and they are seldom restarted.
+ *
+ * Everything is relative to the time elapsed since each alarm started, so
+ * the order and the expiries hold across a millis() rollover. A deadline may
+ * be up to 2^32 - 1 ms.
+ */
+class Alarms
+{
+public:
+    Alarms() = default;
+
+    void schedule(Alarm& alarm);
+    void cancel(Alarm& alarm);
+    void update();
+
+private:
+    Alarm* _head = nullptr;
+};
+
+extern Alarms _alarms;
+
+#endif // ALARMS_H
@@ -0,0 +1,77 @@
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include <stdint.h>
+
+#include "timer.h"
+
+#define AUTOTUNE_CYCLES     4          /**< Number of oscillations measured */
+#define AUTOTUNE_HYSTERESIS 0.25f      /**< Relay hysteresis in C, must be above the sensor noise */
+#define AUTOTUNE_TIMEOUT    10800000UL /**< Give up after 3 hours */
+
+/**
+ * @brief The Autotune class identifies the heater/enclosure dynamics and
+ * computes the PID gains from them.
+ * 
+ * It runs a relay experiment (Astrom-Hagglund): the power is switched between
+ * two levels each time the temperature crosses the setpoint, with a little
+ * hysteresis. That makes the temperature oscillate around the setpoint, and
+ * the period Tu and amplitude a of that oscillation give the ultimate gain
+ * of the system: Ku = 4d / (pi * a), d being half the relay amplitude.
+ * 
+ * The gains are then computed with the Tyreus-Luyben rules, which are more
+ * conservative than Ziegler-Nichols and overshoot a lot less. That suits
+ * the slow thermal processes we deal with.
+ * 
+ * The first oscillation is not measured since it depends on where the
+ * temperature started from.
+ */
+class Autotune
+{
+public:
+    enum Status
+    {
+        Off,
+        Running,
+        Done,
+        Failed
+    };
+
+public:
+    constexpr Autotune() = default;
+
+    void start(float setpoint, float low, float high, float input);
+    void stop();
+
+    Status update(float input);
+
+    bool isRunning() const;
+
+    Status  status = Off;
+    float   output = 0;
+    uint8_t cycles = 0;
+    Timer   timer;
+
+    float kp = 0;
+    float ki = 0;
+    float kd = 0;
+
+private:
+    void switchOutput(bool heat);
+    bool computeGains();
+
+    float _setpoint = 0;
+    float _low      = 0;
+    float _high     = 0;
+    bool  _heating  = false;
+
+    uint8_t       _rises    = 0;
+    unsigned long _lastRise = 0;
+    float         _max      = 0;
+    float         _min      = 0;
+
+    float _periodSum    = 0;
+    float _amplitudeSum = 0;
+};
+
+#endif // AUTOTUNE_H
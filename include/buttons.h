@@ -0,0 +1,106 @@
+#ifndef BUTTONS_H
+#define BUTTONS_H
+
+#include <stdint.h>
+
+#define BUTTON_QUEUE        8   /**< Edges waiting for the main loop, a power of two */
+#define BUTTON_DEBOUNCE     30  /**< Milliseconds after an edge during which the next ones are bounces */
+#define BUTTON_LONG         800 /**< Milliseconds the center button is held for a long press */
+#define BUTTON_REPEAT_DELAY 400 /**< Milliseconds left and right are held before repeating */
+#define BUTTON_REPEAT_START 200 /**< Milliseconds between the first repeats */
+#define BUTTON_REPEAT_MIN   30  /**< Milliseconds between the repeats once at full speed */
+#define BUTTON_POLL         10  /**< Milliseconds between checks while a button is held */
+
+/**
+ * @brief The Buttons class turns the button pin interrupts into events.
+ *
+ * The interrupts only debounce and queue the edges, with their time, in a
+ * single producer single consumer ring buffer: the pin interrupts do not
+ * preempt each other, so they are one producer, the main loop is the
+ * consumer. Each button has its own debounce, so presses on different
+ * buttons are never mistaken for bounces. Nothing is lost while the main loop
+ * is busy, unless BUTTON_QUEUE edges pile up. An edge ignored as a bounce may
+ * have been the last one, a glitch shorter than BUTTON_DEBOUNCE: while a
+ * button is down the main loop reads the pins again once the debounce is
+ * over, and queues the edge missed if any.
+ *
+ * The main loop makes the events from the edges and the time they are held:
+ *  - Left and right make a Press as soon as they are pushed, then Repeat
+ *    events, faster and faster, while they are held.
+ *  - Center makes a Press when released, or a LongPress once held for
+ *    BUTTON_LONG.
+ */
+class Buttons
+{
+public:
+    enum Button
+    {
+        Left,
+        Center,
+        Right,
+
+        ButtonCount
+    };
+
+    enum Kind
+    {
+        Press,
+        LongPress,
+        Repeat
+    };
+
+    struct Event
+    {
+        uint8_t button = ButtonCount;
+        uint8_t kind   = Press;
+    };
+
+public:
+    Buttons() = default;
+
+    void setup();
+
+    bool next(Event& e);
+    bool isHeld() const;
+    void forget();
+
+    unsigned long overflows = 0; /**< Edges lost to a full queue */
+
+private:
+    struct Edge
+    {
+        unsigned long time;
+        uint8_t       button;
+        bool          down;
+    };
+
+    static bool    repeats(uint8_t button);
+    static uint8_t pin(uint8_t button);
+
+    void settle();
+    void sample(uint8_t button);
+
+    static void interruptLeft();
+    static void interruptCenter();
+    static void interruptRight();
+
+    // Written by the interrupts, or with them disabled
+    volatile Edge    _edges[BUTTON_QUEUE];
+    volatile uint8_t _head = 0;
+    unsigned long    _lastEdge[ButtonCount] = {0};
+    bool             _down[ButtonCount]     = {false};
+
+    // Written by the main loop
+    volatile uint8_t _tail = 0;
+    uint8_t          _held = ButtonCount;
+    bool             _long = false;
+    unsigned long    _since      = 0;
+    unsigned long    _nextRepeat = 0;
+    uint16_t         _interval   = BUTTON_REPEAT_START;
+};
+
+static_assert((BUTTON_QUEUE & (BUTTON_QUEUE - 1)) == 0, "BUTTON_QUEUE must be a power of two");
+
+extern Buttons _buttons;
+
+#endif // BUTTONS_H
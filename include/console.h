@@ -0,0 +1,49 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stdint.h>
+
+#define CONSOLE_LINE 32 /**< Longest command line, new line excluded */
+#define CONSOLE_ARGS 4  /**< Most words in a command line */
+
+/**
+ * @brief The Console class lets a host configure the unit with text commands
+ * over the serial port, one per line:
+ *
+ *     status                  temperature, setpoint, power, time left, state
+ *     get setpoint            in C
+ *     set setpoint 31.5
+ *     get bias [sensor]       in C, sensor 0 by default
+ *     set bias [sensor] -0.3
+ *     get timer               in minutes
+ *     set timer 45            and restarts it, as the buttons do
+ *     reset timer
+ *
+ * Each line gets a reply starting with "ok" or "err". Replies travel in
+ * TELEMETRY_TEXT frames, between the samples, see Telemetry.
+ *
+ * The received bytes are taken as they come, so a partial line never waits,
+ * into a fixed buffer: a line longer than CONSOLE_LINE is refused. At most one
+ * command runs per update(). Changes go through the same Controller functions
+ * as the buttons, so they are shown and saved the same way.
+ */
+class Console
+{
+public:
+    Console() = default;
+
+    void update();
+
+    unsigned long commands = 0; /**< Lines received */
+
+private:
+    void execute();
+
+    char    _line[CONSOLE_LINE + 1];
+    uint8_t _length   = 0;
+    bool    _overflow = false;
+};
+
+extern Console _console;
+
+#endif // CONSOLE_H
@@ -1,15 +1,24 @@
 #ifndef CONTROLLER_H
 #define CONTROLLER_H
 
+#include "alarms.h"
+#include "autotune.h"
+#include "buttons.h"
+#include "pid.h"
 #include "timer.h"
 #include "ui.h"
 #include "pins.h"
+#include "profiler.h"
+#include "scheduler.h"
+#include "settings.h"
+#include "thermometer.h"
 #include <Arduino.h>
-#include <EEPROM.h>
 
-#define IDEAL_ADDR 0
-#define TIMER_ADDR IDEAL_ADDR + sizeof(int)
-#define BIAS_ADDR  TIMER_ADDR + sizeof(int)
+#define IDEAL_MAX 990 /**< Highest ideal temperature, in tenths of C */
+
+#ifndef REGULATION_TICK
+#define REGULATION_TICK 0 /**< Milliseconds between regulation ticks, 0 to regulate on each reading from the main loop */
+#endif
 
 /**
  * @brief Th Controller class is the main controller of the program.
@@ -32,23 +41,79 @@ public:
         MenuSetTempBias,
         MenuSetTime,
         MenuResetTime,
+        MenuSetMode,
+        MenuSetSensor,
+        MenuAutotune,
+        MenuHistory,
         MenuShowLoading,
         MenuDebug,
         MenuReturn,
 
         SetTemp,
+        SetAggregate,
         SetTempBias,
+        SetSensorWeight,
         SetTime,
+        SetMode,
+        SetSensor,
+        SetFilter,
+        Autotuning,
+        ShowHistory,
         LoadingScreen,
         Debug
     };
 
+    /**
+     * @brief The tasks of the main loop, in priority order
+     */
+    enum TaskId
+    {
+        PowerTask,
+        SensorTask,
+        RegulationTask,
+        InputTask,
+        SerialTask,
+        RenderTask,
+        SettingsTask,
+
+        TaskCount
+    };
+
+    /**
+     * @brief The pages of the Debug screen
+     */
+    enum DebugPage
+    {
+        DebugOverview,
+        DebugProbes,                                      /**< One page per profiled stage from there */
+        DebugFiring = DebugProbes + Profiler::StageCount, /**< The center button cycles the firing modes */
+        DebugSensors,
+        DebugSleep,
+        DebugTasks,                                       /**< One page per task from there */
+        DebugPageCount = DebugTasks + TaskCount
+    };
+
+    /**
+     * @brief The steps of the main line power sequence
+     */
+    enum PowerState
+    {
+        PowerOff,
+        PowerSyncing,   /**< Waiting for the Pll to lock on the mains */
+        PowerArming,    /**< Triac driven, waiting before closing the relay */
+        PowerSettling,  /**< Relay closed, waiting for it to settle */
+        PowerOn,
+        PowerStopping   /**< Relay opened, waiting before turning the led off */
+    };
+
 public:
     Controller() = default;
 
     void setup();
     void update();
 
+    void updatePower();
+    void pollSensors();
     void updateTemperature();
     void processButtonPressed();
     void updateUI();
@@ -60,11 +125,11 @@ public:
     template<class LCB, class RCB, class CCB>
     void processActions(LCB l, RCB r, CCB c)
     {
-        if(_ui.btnLeftPressed)
+        if(event.button == Buttons::Left)
             l();
-        else if(_ui.btnRightPressed)
+        else if(event.button == Buttons::Right)
             r();
-        else if(_ui.btnCenterPressed)
+        else if(event.button == Buttons::Center)
             c();
     }
 
@@ -114,13 +179,26 @@ public:
     }
     void processMenu(int accept);
 
-    void warmUp();
-    void coolDown();
+    void regulate();
+    void handOff(bool active);
+    static void tick();
+
+    void startAutotune();
+    void stopAutotune();
+    void tune();
 
     void turnOff();
     void turnOn();
 
+    static void screenExpired();
+    static void thermoExpired();
+
     void setIdeal(int i);
+    void setBias(uint8_t i, int bias);
+    void calibrateSensor(uint8_t i);
+    static int nextMode(int mode, int step);
+    static int nextResolution(int res, int step);
+    void setGains(float kp, float ki, float kd);
 
     bool shouldWarmUp()   const;
     bool shouldCoolDown() const;
@@ -128,20 +206,46 @@ public:
     void setTimer(unsigned int m, unsigned int s = 0, unsigned long int z = 0);
     void resetTimer();
 
-    DeadlineTimer screenTimer;
-    DeadlineTimer thermoTimer;
+    Alarm         screenTimer{screenExpired};
+    Alarm         thermoTimer{thermoExpired};
+    DeadlineTimer powerTimer;
+
+    Buttons::Event event; /**< The one being processed */
+
+    Pid      pid;
+    Autotune autotune;
 
     int lastState = Idle;
     int state = Idle;
 
     bool isTurnedOn = false;
+    int  powerState = PowerOff;
 
-    int ideal       = 0;
+    int ideal       = 0; /**< In tenths of C */
     int idealTmp    = 0;
 
     int timerTmp    = 0;
 
-    float biasTmp = 0;
+    int biasTmp = 0;
+
+    int aggregateTmp = 0;
+    int weightTmp    = 0;
+    uint8_t sensorIndex = 0;
+
+    int modeTmp = 0;
+
+    int sensorTmp = 0;
+    int filterTmp = 0;
+
+    int debugPage = 0;
+
+    volatile int16_t tickTemperature = 0;     /**< What the tick regulates on, see handOff() */
+    volatile int16_t tickIdeal       = 0;
+    volatile bool    ticking         = false; /**< Whether the tick drives the power */
+    unsigned long    lastTick        = 0;     /**< In us, tick only */
+    unsigned long    lastTickPeriod  = 0;
+
+    static Task tasks[TaskCount];
 };
 
 extern Controller _controller;
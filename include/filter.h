@@ -0,0 +1,93 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdint.h>
+
+#define FILTER_EMA_TAU   4000    /**< Time constant of the Ema filter, in milliseconds */
+#define FILTER_MEDIAN_N  5       /**< Readings the Median filter picks from */
+#define FILTER_KALMAN_Q  1.0f    /**< Kalman process noise, in (1/TEMP_ONE C)^2 per second */
+#define FILTER_KALMAN_R0 16.0f   /**< Kalman measurement noise on top of the quantization, in (1/TEMP_ONE C)^2 */
+
+#define TREND_N    20   /**< Samples the slope is fitted on */
+#define TREND_SLOT 1000 /**< Shortest time between 2 of those samples, in milliseconds */
+
+/**
+ * @brief The Filter class smooths the temperature readings, each update takes
+ * the same time whatever the settings.
+ *
+ * Temperatures are in 1/TEMP_ONE C, as read from the sensors.
+ *  - Ema is an exponential moving average. It weighs the new reading by the
+ *    time elapsed, so its time constant does not depend on the sensor
+ *    resolution.
+ *  - Median takes the median of the last FILTER_MEDIAN_N readings. It does
+ *    not lag as much on a ramp and ignores isolated outliers.
+ *  - Kalman is a one state Kalman filter. It trusts the readings more when
+ *    the resolution is high, and less at 9 bits where they are 0.5C steps.
+ */
+class Filter
+{
+public:
+    enum Mode
+    {
+        None,
+        Ema,
+        Median,
+        Kalman,
+        ModeCount
+    };
+
+public:
+    constexpr Filter() = default;
+
+    void setMode(uint8_t m);
+    void reset();
+
+    static const char* name(uint8_t mode);
+
+    int16_t update(int16_t x, unsigned long dt, uint8_t bits);
+
+    uint8_t mode = Ema;
+
+private:
+    int16_t median(int16_t x);
+
+    bool    _primed = false;
+    int32_t _ema    = 0; /**< In 1/16 of 1/TEMP_ONE C */
+
+    int16_t _last[FILTER_MEDIAN_N] = {0};
+    uint8_t _lastCount = 0;
+    uint8_t _lastIndex = 0;
+
+    float _x = 0;
+    float _p = 0;
+};
+
+/**
+ * @brief The Trend class estimates how fast the temperature changes.
+ *
+ * The samples are decimated to one every TREND_SLOT milliseconds at least,
+ * then a least squares line is fitted on the last TREND_N of them. The sums
+ * it needs are updated as samples come and go in the ring buffer, so the fit
+ * takes the same time whatever TREND_N.
+ */
+class Trend
+{
+public:
+    constexpr Trend() = default;
+
+    void reset();
+    void update(int16_t x, unsigned long now);
+
+    int16_t slope = 0; /**< In 1/TEMP_ONE C per minute */
+
+private:
+    int16_t       _ring[TREND_N] = {0};
+    uint8_t       _count = 0;
+    uint8_t       _head  = 0;
+    int32_t       _s0    = 0; /**< Sum of the samples */
+    int32_t       _s1    = 0; /**< Sum of the samples times their index, the oldest is 0 */
+    unsigned long _last   = 0;
+    unsigned long _period = TREND_SLOT; /**< Milliseconds between the last 2 samples */
+};
+
+#endif // FILTER_H
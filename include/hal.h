@@ -0,0 +1,35 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+
+#define FIRING_TICK_US 4  /**< Duration of a firing timer tick in microseconds */
+#define GATE_PULSE_US  10 /**< Duration of the triac gate pulse in microseconds */
+
+/**
+ * @brief The hal namespace gathers what talks to the ATmega4809 peripherals
+ * directly. Everything else goes through the Arduino API.
+ * 
+ * The Nano Every build implements it in hal_avr.cpp. The native build links
+ * against the simulated board in native/ instead, which also provides the
+ * Arduino API and the libraries we use.
+ */
+namespace hal
+{
+
+void setupFiringTimer();
+void setHardwareGate(bool enabled);
+void setEdgeStart(bool enabled);
+void setFiringTicks(uint16_t ticks);
+void startFiringTimer(uint16_t ticks);
+void stopFiringTimer();
+bool isFiringTimerRunning();
+long firingLatency();
+void setGate(bool on);
+bool eepromBusy();
+void idle();
+void setupTick(uint16_t ms, void (*handler)());
+
+}
+
+#endif // HAL_H
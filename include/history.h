@@ -0,0 +1,77 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdint.h>
+
+#include "alarms.h"
+
+#define HISTORY_LEN       96  /**< Entries kept, one per column of the sparkline */
+#define HISTORY_PERIOD    120 /**< Default seconds per entry, 96 entries are then 3.2 hours */
+#define HISTORY_MAX_BYTES 640 /**< What the recorder may cost in SRAM */
+
+/**
+ * @brief The History class records how the temperature and the power went,
+ * in a fixed amount of SRAM.
+ *
+ * Every period, the readings received meanwhile are decimated into one Entry:
+ * the lowest and highest temperature, the mean power and the setpoint. The
+ * entries are kept in a ring buffer, the oldest is overwritten when it is
+ * full. So the spikes stay visible however long the period is, and the
+ * buffer covers HISTORY_LEN periods.
+ *
+ * It is lost at reboot, so is the period which defaults to HISTORY_PERIOD.
+ */
+class History
+{
+public:
+    /**
+     * @brief A period worth of readings
+     */
+    struct Entry
+    {
+        int16_t min;      /**< In 1/TEMP_ONE C */
+        int16_t max;      /**< In 1/TEMP_ONE C */
+        uint8_t power;    /**< In % */
+        uint8_t setpoint; /**< In half C, the setpoint moves by 0.5C */
+    };
+
+    static constexpr uint16_t bytes = HISTORY_LEN * sizeof(Entry);
+
+public:
+    History() = default;
+
+    void setup();
+    void clear();
+    void setPeriod(uint16_t s);
+    static uint16_t nextPeriod(uint16_t s, int step);
+
+    void add(int16_t temperature, int setpoint, unsigned int power);
+
+    uint8_t size() const;
+    const Entry& at(uint8_t i) const;
+
+    uint16_t period = HISTORY_PERIOD; /**< In seconds */
+    uint8_t  revision = 0;            /**< Changes with the content */
+
+    Alarm periodTimer{periodEnded};
+
+private:
+    void close();
+    static void periodEnded();
+
+    Entry   _entries[HISTORY_LEN];
+    uint8_t _head  = 0;
+    uint8_t _count = 0;
+
+    int16_t  _min = 0;
+    int16_t  _max = 0;
+    uint32_t _powerSum = 0;
+    uint16_t _samples  = 0;
+    uint8_t  _setpoint = 0;
+};
+
+static_assert(History::bytes <= HISTORY_MAX_BYTES, "History does not fit in its SRAM budget");
+
+extern History _history;
+
+#endif // HISTORY_H
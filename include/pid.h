@@ -0,0 +1,56 @@
+#ifndef PID_H
+#define PID_H
+
+#define PID_KP 1000.0f /**< Default proportional gain, in 1/100 % of power per C */
+#define PID_KI 2.0f    /**< Default integral gain, in 1/100 % of power per C per second */
+#define PID_KD 0.0f    /**< Default derivative gain, in 1/100 % of power per C/s */
+#define PID_N  2.0f    /**< The derivative is low-pass filtered with a Td/N time constant */
+
+/**
+ * @brief The Pid class is a PID regulator.
+ * 
+ * It is meant to be computed once per fresh measurement, with the time elapsed
+ * since the previous one. The gains are then expressed in seconds and do not
+ * depend on how fast the main loop runs.
+ * 
+ * A few classic refinements:
+ *  - The integral term is clamped to the output limits, so it does not keep
+ *    growing while the output is saturated (anti-windup).
+ *  - The derivative acts on the measurement rather than the error, so a
+ *    setpoint change does not kick the output. It is low-pass filtered, the
+ *    sensor steps would make it jump otherwise.
+ *  - After reset(), the first computation picks the integral term so the
+ *    output continues from where it was (bumpless transfer).
+ */
+class Pid
+{
+public:
+    constexpr Pid() = default;
+
+    void setup();
+
+    void setGains(float p, float i, float d);
+    void setLimits(float min, float max);
+    void reset(float out);
+
+    float compute(float setpoint, float input, float dt);
+
+    float kp = PID_KP;
+    float ki = PID_KI;
+    float kd = PID_KD;
+
+    float outMin = 0;
+    float outMax = 0;
+
+    float integral   = 0;
+    float derivative = 0;
+    float lastInput  = 0;
+    float output    = 0;
+
+private:
+    float clamp(float v) const;
+
+    bool _primed = false;
+};
+
+#endif // PID_H
@@ -0,0 +1,71 @@
+#ifndef PLL_H
+#define PLL_H
+
+#include <stdint.h>
+
+#define PLL_SHIFT      4     /**< Timestamps are kept in 1/16 us */
+#define PLL_MIN_HALF   7500  /**< Shortest half period accepted, in us (66Hz) */
+#define PLL_MAX_HALF   11000 /**< Longest half period accepted, in us (45Hz) */
+#define PLL_MIN_PULSE  50    /**< Shorter zero crossing pulses are glitches, in us */
+#define PLL_MAX_PULSE  2000  /**< Longer zero crossing pulses are glitches, in us */
+#define PLL_WINDOW     400   /**< Edges further than that from the prediction are glitches, in us */
+#define PLL_ACQUIRE    8     /**< Consistent half-cycles needed to lock */
+#define PLL_MAX_MISSES 8     /**< Half-cycles without a valid edge before losing the lock */
+#define PLL_KP_SHIFT   2     /**< The phase is corrected by 1/4 of the error */
+#define PLL_KI_SHIFT   5     /**< The period is corrected by 1/32 of the error */
+
+/**
+ * @brief The Pll class is a software phase-locked loop following the mains.
+ *
+ * It is fed with the timestamps of both edges of the zero crossing pulses. The
+ * middle of a pulse is where the current actually crosses 0, but a single
+ * pulse is too noisy to rely on: the detector jitters and the interrupt
+ * latency changes with what the controller was doing.
+ *
+ * So instead, it predicts when the next zero is going to happen from the
+ * half period and phase it has been tracking, and only nudges them by a
+ * fraction of the error once the pulse has been measured (a classic second
+ * order loop). Edges that land too far from the prediction are rejected as
+ * glitches and a few missing pulses do not matter.
+ *
+ * Until it is locked, it looks for a few consecutive half periods that agree
+ * with each other, which also tells whether the mains runs at 50 or 60Hz.
+ *
+ * Both edge functions are meant to be called from an interrupt.
+ */
+class Pll
+{
+public:
+    constexpr Pll() = default;
+
+    void reset();
+
+    void rising(unsigned long now);
+    void falling(unsigned long now);
+
+    bool expectsRise(unsigned long now) const;
+    long timeTo(unsigned long now, unsigned int offset) const;
+
+    unsigned int halfPeriod() const;
+    unsigned int pulseWidth() const;
+    uint8_t frequency() const;
+
+    volatile bool locked = false;
+    volatile uint8_t glitches = 0;
+
+private:
+    void unlock();
+    void acquire(uint32_t center, uint32_t width);
+
+    uint32_t _rise       = 0;
+    bool     _hasRise    = false;
+    uint32_t _lastCenter = 0;
+    uint8_t  _acquired   = 0;
+    uint8_t  _misses     = 0;
+
+    uint32_t _zero   = 0;
+    uint32_t _period = 0;
+    uint32_t _pulse  = 0;
+};
+
+#endif // PLL_H
@@ -0,0 +1,28 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+
+#define POWER_MAX   10000 /**< Full power, powers are in 1/100 % */
+#define POWER_STEPS 64    /**< Intervals of the linearization table */
+
+/**
+ * @brief The power namespace converts a power into the phase angle that
+ * delivers it.
+ * 
+ * A resistive load fired at a fraction a of the half-cycle receives
+ * 1 - a + sin(2.pi.a)/(2.pi) of the full power. So the power is anything but
+ * linear with the firing delay: it barely moves at both ends and changes
+ * fast around the middle.
+ * 
+ * The inverse of that curve is tabulated at compile time, in flash, and
+ * interpolated linearly.
+ */
+namespace power
+{
+
+uint16_t toAngle(unsigned int p);
+
+}
+
+#endif // POWER_H
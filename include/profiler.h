@@ -0,0 +1,108 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+
+#define PROBE_BUCKETS 16 /**< Bucket i counts durations in [2^i, 2^(i+1)[ us */
+
+/**
+ * @brief The Probe class accumulates the durations of a stage of the program.
+ * 
+ * It keeps the min, max and mean durations and a log2 bucketed histogram.
+ * Recording is cheap enough to be done from an ISR.
+ *
+ * Probes are always on. Before the sum or a bucket would overflow, the
+ * histogram, the sum and the count are all halved: the shape and the mean
+ * hold, the older durations just weigh less. count is then no longer the
+ * number of durations recorded.
+ */
+class Probe
+{
+public:
+    constexpr Probe() = default;
+
+    void record(unsigned long us);
+    void reset();
+
+    unsigned long mean() const;
+
+    unsigned long min   = 0xFFFFFFFF;
+    unsigned long max   = 0;
+    unsigned long count = 0;
+    unsigned long sum   = 0;
+
+    uint16_t buckets[PROBE_BUCKETS] = {0};
+
+private:
+    void halve();
+};
+
+
+
+// =============================================================================
+
+
+
+/**
+ * @brief The Profiler class holds a probe per stage of the program.
+ * 
+ * It is always on. Main loop stages are recorded with a ScopedProbe, ISRs
+ * record themselves.
+ */
+class Profiler
+{
+public:
+    /**
+     * @brief The profiled stages
+     */
+    enum Stage
+    {
+        Loop,
+        Temperature,
+        Buttons,
+        Render,
+        ZeroCrossIsr,
+        FiringIsr,
+        FiringLatency,  /**< From the zero crossing edge to the firing timer start */
+        TickIsr,        /**< The regulation tick, see REGULATION_TICK */
+        TickJitter,     /**< How much a tick period differs from the previous one */
+
+        StageCount
+    };
+
+public:
+    constexpr Profiler() = default;
+
+    void record(uint8_t stage, unsigned long us);
+    void snapshot(uint8_t stage, Probe& probe) const;
+    void reset();
+    void reset(uint8_t stage);
+
+    static const char* name(uint8_t stage);
+
+    Probe probes[StageCount];
+};
+
+extern Profiler _profiler;
+
+
+
+// =============================================================================
+
+
+
+/**
+ * @brief The ScopedProbe class records the time spent in its scope
+ */
+class ScopedProbe
+{
+public:
+    explicit ScopedProbe(uint8_t stage);
+    ~ScopedProbe();
+
+private:
+    uint8_t       _stage;
+    unsigned long _start;
+};
+
+#endif // PROFILER_H
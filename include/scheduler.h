@@ -0,0 +1,75 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+#include "timer.h"
+
+/**
+ * @brief A piece of the main loop and how often it runs
+ */
+struct Task
+{
+    constexpr Task(const char* name, void (*run)(), uint16_t period, uint16_t budget) :
+        name(name), run(run), period(period), budget(budget) {}
+
+    const char* name;
+    void (*run)();
+    uint16_t period;            /**< In ms, 0 to only run when signalled */
+    uint16_t budget;            /**< In us, a longer run is an overrun */
+
+    DeadlineTimer timer;
+    volatile bool signalled = false;
+    bool          suspended = false;
+    unsigned long runs     = 0;
+    unsigned long overruns = 0;
+    unsigned long longest  = 0; /**< In us */
+    uint16_t      late     = 0; /**< In ms, the most a run started after its deadline */
+};
+
+/**
+ * @brief The Scheduler class runs the main loop from a static table of tasks.
+ *
+ * Each task runs once its period elapsed, or once an interrupt signalled it
+ * has something to do. The table is in priority order: a pass runs the first
+ * task due and returns, so the ones before it are checked again before the
+ * ones after it get their turn. A suspended task does not run at all.
+ *
+ * When none is due, the CPU sleeps in idle mode until the next interrupt, the
+ * millis() tick at the latest. Only the CPU stops: the timers firing the triac
+ * keep running and it is awake again within a few cycles. The time spent
+ * asleep and awake is accounted.
+ *
+ * Nothing preempts a task. A run longer than its budget is counted as an
+ * overrun, a run starting after its deadline tells how late.
+ */
+class Scheduler
+{
+public:
+    Scheduler() = default;
+
+    void setup(Task* tasks, uint8_t count);
+    bool runNext();
+    void idle();
+
+    void signal(uint8_t i);
+    void suspend(uint8_t i);
+    void resume(uint8_t i);
+    void setPeriod(uint8_t i, uint16_t period);
+
+    Task*   tasks = nullptr;
+    uint8_t count = 0;
+
+    unsigned long idles  = 0;
+    unsigned long asleep = 0; /**< In ms */
+    unsigned long awake  = 0; /**< In ms */
+
+private:
+    unsigned long _mark     = 0; /**< In us, when the CPU last woke up */
+    uint16_t      _asleepUs = 0; /**< Less than a ms, not accounted yet */
+    uint16_t      _awakeUs  = 0;
+};
+
+extern Scheduler _scheduler;
+
+#endif // SCHEDULER_H
@@ -0,0 +1,105 @@
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <stdint.h>
+
+#include "pid.h"
+#include "thermometer.h"
+#include "timer.h"
+
+#define SETTINGS_VERSION 1    /**< Bump when Config changes, older records are then ignored */
+#define SETTINGS_QUIET   5000 /**< Milliseconds without a change before committing */
+
+/**
+ * @brief The values kept across reboots
+ */
+struct Config
+{
+    int16_t  ideal = 0;            /**< In tenths of C */
+    uint32_t timer = 0;            /**< In milliseconds */
+    float    kp    = PID_KP;
+    float    ki    = PID_KI;
+    float    kd    = PID_KD;
+    int8_t   bias[THERMO_MAX_SENSORS]   = {0};         /**< In tenths of C */
+    uint8_t  weight[THERMO_MAX_SENSORS] = {1, 1, 1, 1};
+    uint8_t  aggregate  = Thermometer::Mean;
+    uint8_t  filter     = Filter::Ema;
+    uint8_t  resolution = THERMO_RESOLUTION;
+    uint8_t  burst      = 0;       /**< Burst cycles, 0 for phase angle */
+};
+
+/**
+ * @brief The Settings class keeps the Config in EEPROM.
+ *
+ * The EEPROM is split into slots, each holding a whole record: a version, a
+ * sequence number, the Config and a CRC. Every commit goes to the slot after
+ * the newest one, so the writes spread over the whole EEPROM and a commit cut
+ * short by a power loss leaves the previous record intact. At boot, the valid
+ * record with the newest sequence number wins. Without any, the values saved
+ * at fixed addresses by older versions are used.
+ *
+ * Changes are not written right away. The commit starts once nothing changed
+ * for SETTINGS_QUIET milliseconds, so going through values with the buttons
+ * costs a single record. It is then written one byte per update(), only when
+ * the EEPROM is done with the previous one: nothing ever waits for it.
+ */
+class Settings
+{
+public:
+    /**
+     * @brief A slot of the EEPROM
+     */
+    struct Record
+    {
+        uint8_t  version;
+        uint16_t sequence;
+        Config   config;
+        uint16_t crc;
+    };
+
+public:
+    Settings() = default;
+
+    void load();
+    void update();
+
+    /**
+     * @brief Sets @a field, a member of config, to @a value and schedules a
+     * commit if it changed.
+     */
+    template<class T, class V>
+    void set(T& field, V value)
+    {
+        if(field != static_cast<T>(value))
+        {
+            field = static_cast<T>(value);
+            touch();
+        }
+    }
+
+    void touch();
+    bool isCommitting() const;
+
+    static uint8_t  slotCount();
+    static uint16_t crc(const uint8_t* data, uint16_t len);
+
+    Config config;
+
+    DeadlineTimer quietTimer;
+    uint16_t      sequence = 0;
+    uint8_t       slot     = 0; /**< Where the newest record is */
+    bool          dirty    = false;
+    unsigned long commits  = 0;
+
+private:
+    void loadLegacy();
+    void startCommit();
+
+    Record   _image;            /**< What is being written */
+    uint16_t _written = sizeof(Record);
+    uint16_t _addr    = 0;
+};
+
+extern Settings _settings;
+
+#endif // SETTINGS_H
@@ -0,0 +1,104 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+#include "timer.h"
+
+#define TELEMETRY_BAUD    115200
+#define TELEMETRY_PERIOD  100    /**< Milliseconds between samples, 10Hz */
+#define TELEMETRY_BUFFER  128    /**< Bytes of encoded frames waiting for the UART */
+#define TELEMETRY_PAYLOAD 48     /**< Longest frame content, before encoding */
+#define TELEMETRY_SAMPLE  0x01   /**< Frame type of a Sample, changes with its layout */
+#define TELEMETRY_TEXT    0x02   /**< Frame type of a line of text, see Console */
+
+/**
+ * @brief The Telemetry class streams what the regulation does over the USB
+ * serial port, for a host to log it.
+ *
+ * Every TELEMETRY_PERIOD a Sample is taken and COBS encoded into a frame
+ * ending with a 0, the only 0 of the frame: a host joining mid-stream syncs on
+ * the next one. Frames wait in a ring buffer that is moved to the transmit
+ * buffer of the core, emptied by the UART interrupt, only as much as it has
+ * room for. So the main loop never waits for the serial port. When the host
+ * does not keep up, the ring buffer fills and the samples that do not fit are
+ * dropped and counted.
+ *
+ * Multi-byte values are little endian. tools/telemetry_decode.py decodes the
+ * stream into CSV.
+ */
+class Telemetry
+{
+public:
+    /**
+     * @brief What a frame carries
+     */
+    struct __attribute__((packed)) Sample
+    {
+        uint8_t  type;        /**< TELEMETRY_SAMPLE */
+        uint16_t sequence;    /**< Gaps tell the samples dropped */
+        uint32_t time;        /**< In ms since boot */
+        int16_t  temperature; /**< In 1/TEMP_ONE C, filtered */
+        int16_t  raw;         /**< In 1/TEMP_ONE C, as read */
+        int16_t  slope;       /**< In 1/TEMP_ONE C per minute */
+        int16_t  ideal;       /**< In tenths of C */
+        uint16_t power;       /**< In 1/100 % */
+        uint16_t triacDelay;  /**< In us */
+        uint16_t syncDelay;   /**< In us */
+        uint16_t loopTime;    /**< In us, last loop */
+        uint16_t loopMax;     /**< In us, longest loop since the last sample */
+        uint8_t  state;       /**< Controller::State */
+        uint8_t  powerState;  /**< Controller::PowerState */
+        uint16_t drops;       /**< Samples dropped so far */
+    };
+
+    /**
+     * @brief Longest frame: the code bytes, one per 254 bytes of content, and
+     * the delimiter
+     */
+    static constexpr uint8_t frameMax = TELEMETRY_PAYLOAD + TELEMETRY_PAYLOAD/254 + 2;
+
+public:
+    Telemetry() = default;
+
+    void setup();
+    void update();
+
+    /**
+     * @brief Keeps the longest loop of @a us microseconds until the next
+     * sample
+     */
+    void recordLoop(unsigned long us)
+    {
+        if(us > _loopMax)
+            _loopMax = us > 0xFFFF ? 0xFFFF : us;
+    }
+
+    bool send(const uint8_t* data, uint8_t len);
+
+    static uint8_t encode(const uint8_t* data, uint8_t len, uint8_t* frame);
+
+    uint16_t pending() const;
+
+    uint16_t sequence = 0;
+    uint16_t drops    = 0;
+
+    DeadlineTimer sampleTimer;
+
+private:
+    void sample();
+    void drain();
+
+    uint8_t  _buffer[TELEMETRY_BUFFER];
+    uint8_t  _head = 0; /**< Where the next byte goes */
+    uint8_t  _tail = 0; /**< Next byte to send */
+    uint16_t _loopMax = 0;
+};
+
+static_assert(sizeof(Telemetry::Sample) <= TELEMETRY_PAYLOAD, "Sample does not fit in a frame");
+static_assert((TELEMETRY_BUFFER & (TELEMETRY_BUFFER - 1)) == 0 && TELEMETRY_BUFFER <= 256,
+              "TELEMETRY_BUFFER must be a power of two of at most 256");
+
+extern Telemetry _telemetry;
+
+#endif // TELEMETRY_H
@@ -4,31 +4,111 @@
 #include <OneWire.h>
 #include <DallasTemperature.h>
 
+#include "filter.h"
 #include "pins.h"
+#include "timer.h"
 #include "utils.h"
 
-#define N_AVG    100
 #define MAX_READ 1024
 #define A_REF    1.1
 
+#define THERMO_RESOLUTION 12  /**< Default resolution, in bits (9 to 12) */
+#define THERMO_ADAPTIVE   0   /**< Resolution setting that picks it from the distance to the target */
+#define THERMO_FAST_BITS  9   /**< Resolution used far from the target in adaptive mode */
+#define THERMO_NEAR       (1 * TEMP_ONE) /**< Adaptive mode is precise within that distance of the target */
+#define THERMO_FAR        (2 * TEMP_ONE) /**< Adaptive mode goes fast beyond that distance of the target */
+
+#define THERMO_MAX_SENSORS 4  /**< Sensors used on the bus, any other is ignored */
+#define THERMO_MAX_BIAS    50 /**< Largest sensor bias, in tenths of C */
+#define THERMO_MAX_WEIGHT  10 /**< Largest sensor weight */
+
+/**
+ * @brief A DS18B20 on the bus, with its own calibration
+ */
+struct Sensor
+{
+    DeviceAddress addr = {0, 0, 0, 0, 0, 0, 0, 0};
+
+    int16_t temperature = 0;     /**< Last reading in 1/TEMP_ONE C, bias included */
+    int16_t bias        = 0;     /**< In tenths of C */
+    uint8_t weight      = 1;     /**< Share of the Weighted aggregate */
+    bool    present     = false; /**< Whether the last reading succeeded */
+};
+
 /**
  * @brief The Thermometer class is responsible for managing the temperature sensor.
+ *
+ * A conversion takes 94ms at 9 bits and up to 750ms at 12 bits. Rather than
+ * polling the sensor until it is done, the bus is left alone until the
+ * conversion time of the configured resolution has elapsed.
+ *
+ * In adaptive mode, conversions are fast and coarse while the temperature is
+ * far from the target and precise close to it, where it matters.
+ *
+ * Up to THERMO_MAX_SENSORS sensors can share the bus. They all convert at once
+ * from a single broadcast (skip ROM) request, so more sensors do not make the
+ * readings slower. Their readings are combined into raw, see Aggregate. A
+ * sensor that does not answer is left out until it answers again.
+ *
+ * The combined reading is then smoothed into temperature, see Filter, and its
+ * slope estimated, see Trend.
  */
 class Thermometer
 {
+public:
+    /**
+     * @brief How the sensor readings make the temperature
+     */
+    enum Aggregate
+    {
+        Mean,
+        Min,
+        Max,
+        Weighted,
+        AggregateCount
+    };
+
 public:
     Thermometer();
 
     void setup();
     void update();
 
-    float temperature = 0;
-    float bias = 0;
+    bool hasNewReading();
+
+    void setResolution(uint8_t r);
+    void setTarget(int16_t t);
+    uint8_t bits() const;
+    void setAggregate(uint8_t a);
+    void setFilter(uint8_t f);
+    uint8_t presentCount() const;
+
+    int16_t raw         = 0; /**< In 1/TEMP_ONE C, aggregate of the sensors present */
+    int16_t temperature = 0; /**< In 1/TEMP_ONE C, raw once filtered */
+
+    Filter  filter;
+    Trend   trend;
+
+    Sensor  sensors[THERMO_MAX_SENSORS];
+    uint8_t sensorCount = 0;
+    uint8_t aggregate   = Mean;
+
+    Timer         sampleTimer;
+    unsigned long samplePeriod = 0; /**< Milliseconds between the last 2 readings */
+
+    uint8_t       resolution = THERMO_RESOLUTION; /**< In bits, or THERMO_ADAPTIVE */
+    int16_t       target     = 0;                 /**< In 1/TEMP_ONE C, bias included */
+    DeadlineTimer conversionTimer;
 
 private:
+    void applyResolution(uint8_t b);
+    void startConversion();
+    bool combine();
+
+    uint8_t           _bits = 0;
+    bool              _newReading = false;
     OneWire           _one;
     DallasTemperature _dallas;
-    DeviceAddress     _addr = {0, 0, 0, 0, 0, 0, 0, 0};
 };
 
 extern Thermometer _thermo;
@@ -4,24 +4,31 @@
 #include <stdint.h>
 
 #include "pins.h"
-#include "timer.h"
+#include "pll.h"
+
+#define FIRE_GUARD       100 /**< Microseconds kept clear on both sides of a zero crossing */
+#define BURST_MAX_CYCLES 200 /**< Longest burst fire resolution, in mains cycles */
 
 /**
  * @brief The Triac class is responsible of driving the triac.
  * 
  * For those who wonder, when you use a triac to control how much power you send
  * to a fixture, you need to time it right. The delay you wait between the current
- * crossing 0 and the moment you drive the triac is directly proportional to
- * the power the fixture will receive.
+ * crossing 0 and the moment you drive the triac decides the power the fixture
+ * will receive, though not linearly (see power.h).
  * 
  * It uses a couple of tricks to avoid the use of delays that would block the
  * controller to do other things such as refreshing the screen and make the
  * Screen and buttons feel laggy.
  * 
- * Each time the main line crosses 0, an interrupt is triggered (zeroDetect()).
- * In this interrupt, the program starts a hardware timer that has been setup to
- * trigger a second interrupt exactly when we want the triac to be driven.
- * In this second interrupt, it drives the triac and stops the timer.
+ * Each time the zero crossing pulse starts, an interrupt is triggered
+ * (zeroDetected()). In this interrupt, the program starts a hardware timer that
+ * has been setup to drive the triac exactly when we want, without any further
+ * interrupt (see hal::setupFiringTimer()).
+ *
+ * The delay is counted from where the Pll predicts the current crosses 0
+ * rather than from the pulse itself, so the detector jitter and the interrupt
+ * latency do not move the firing point.
  */
 class Triac 
 {
@@ -30,29 +37,54 @@ public:
 
     void setup();
     
-    void setDelay(unsigned int us);
-    void incDelay(unsigned int a);
-    void decDelay(unsigned int a);
+    void setPower(unsigned int p);
 
-    void detectSync();
+    void startSync();
+    bool updateSync();
+    void stopSync();
     void turnOn();
     void turnOff();
 
-    void updateTickCount();
+    void setHardwareGate(bool enabled);
+    void setEdgeStart(bool enabled);
+    void setBurst(uint8_t cycles);
+    void configure();
+    void update();
+    void updateFiringOffset();
 
     void setupCounter();
-    void startCounter();
+    void startCounter(unsigned long now);
     void stopCounter();
     bool isRunning();
 
+    void nextHalfCycle();
+
     static void zeroDetected();
     static void timeout();
 
+    Pll pll;
+
+    unsigned int  power      = 0;
+    unsigned int  halfPeriod = 0;
     unsigned long syncDelay  = 0;
     unsigned long triacDelay = 0;
     unsigned long triacMax   = 0;
 
-    volatile uint16_t tickCount = 0;
+    bool hardwareGate = true;
+    bool edgeStart    = false;
+
+    uint16_t edgeTicks    = 0;
+    bool     ticksPending = false;
+
+    volatile uint8_t burstCycles = 0;
+    volatile uint8_t burstOn     = 0;
+    uint16_t burstAcc        = 0; /**< Up to 2*burstCycles - 1 */
+    bool     burstSecondHalf = false;
+    bool     burstFire       = false;
+
+    volatile bool     firing       = false;
+    volatile uint16_t firingOffset = FIRE_GUARD;
+    volatile uint16_t tickCount    = 0;
 };
 
 extern Triac _triac;
@@ -5,12 +5,83 @@
 
 #include "timer.h"
 
+#define SCREEN_ADDR  0x3C                   /**< I2C address of the SSD1306 */
+#define SCREEN_PAGES (SSD1306_LCDHEIGHT/8)  /**< Number of 8 pixels high pages */
+#define SPAN_GAP     8                      /**< Unchanged columns worth sending to avoid a new span */
+#define UI_MAX_FPS   25                     /**< Default maximum redraw rate */
+
 /**
  * @brief The Ui class is responsible of drawing stuff on the screen and detect
  * user interraction.
  */
 class Ui
 {
+public:
+    /**
+     * @brief The model values a screen can depend on
+     */
+    enum Dependency
+    {
+        DependsOnState       = 0x01,
+        DependsOnTemperature = 0x02,
+        DependsOnPower       = 0x04,
+        DependsOnCountdown   = 0x08,
+        DependsOnSettings    = 0x10,
+        DependsOnAutotune    = 0x40,
+        DependsOnHistory     = 0x80,
+        DependsOnTick        = 0x20  /**< Redraw on every frame tick */
+    };
+
+    /**
+     * @brief A snapshot of the values displayed on screen
+     */
+    struct Model
+    {
+        int           state       = -1;
+        int           temperature = 0;
+        unsigned int  triacPower  = 0;
+        int           power       = 0;
+        unsigned long countdown   = 0;
+        int           ideal       = 0;
+        int           idealTmp    = 0;
+        int           timerTmp    = 0;
+        int           modeTmp     = 0;
+        int           sensorTmp   = 0;
+        int           filterTmp   = 0;
+        int           biasTmp     = 0;
+        int           aggregateTmp = 0;
+        int           weightTmp   = 0;
+        uint8_t       sensorIndex = 0;
+        uint8_t       autotune    = 0;
+        uint8_t       cycles      = 0;
+        unsigned long elapsed     = 0;
+        uint8_t       history     = 0;
+    };
+
+    /**
+     * @brief A screen is a draw function and the model values it depends on
+     */
+    struct Screen
+    {
+        void (Ui::*draw)();
+        uint8_t dependencies;
+    };
+
+    static const Screen loadingScreen;
+    static const Screen idleScreen;
+    static const Screen menuScreen;
+    static const Screen setTempScreen;
+    static const Screen setTempBiasScreen;
+    static const Screen setAggregateScreen;
+    static const Screen setWeightScreen;
+    static const Screen setTimeScreen;
+    static const Screen setModeScreen;
+    static const Screen setSensorScreen;
+    static const Screen setFilterScreen;
+    static const Screen autotuneScreen;
+    static const Screen historyScreen;
+    static const Screen debugScreen;
+
 public:
     Ui();
     
@@ -24,31 +95,51 @@ public:
     void drawMenuScreen();
     void drawSetTempScreen();
     void drawSetTempBiasScreen();
+    void drawSetAggregateScreen();
+    void drawSetWeightScreen();
+    void drawSensorIndex();
     void drawSetTimeScreen();
+    void drawSetModeScreen();
+    void drawSetSensorScreen();
+    void drawSetFilterScreen();
+    void drawAutotuneScreen();
+    void drawHistoryScreen();
     void drawDebugScreen();
+    void drawProbePage(uint8_t stage);
+    void drawFiringPage();
+    void drawSensorsPage();
+    void drawSleepPage();
+    void drawTaskPage(uint8_t i);
 
     void drawButton(int x, int y, char c);
 
-    bool hasButtonBeenPressed() const;
-    void resetButtons();
+    void setMaxFps(uint8_t fps);
+    void invalidate();
+    void render(const Screen& screen);
+    void snapshot(Model& model) const;
+    bool hasChanged(const Model& model, uint8_t dependencies) const;
 
-    void setupInterrupt();
-    void removeInterrupt();
-
-    static void interrupt(volatile bool& btn);
-    static void interrupt1();
-    static void interrupt2();
-    static void interrupt3();
+    void flush();
+    void sendSpan(uint8_t page, uint8_t start, uint8_t end);
 
 public:
-    volatile bool  btnLeftPressed   = false;
-    volatile bool  btnCenterPressed = false;
-    volatile bool  btnRightPressed  = false;
-
     bool isTurnedOn = true;
     Adafruit_SSD1306 display;
 
-    MicroTimer loopTimer;
+    MicroTimer    loopTimer;
+    unsigned long loopTime = 0;
+
+    DeadlineTimer frameTimer;
+    unsigned long redrawCount  = 0;
+    unsigned long skippedCount = 0;
+
+private:
+    const Screen* _screen = nullptr;
+    Model         _model;
+
+
+    uint8_t _shadow[SSD1306_LCDWIDTH * SCREEN_PAGES];
+    bool    _fullRefresh = true;
 };
 
 extern Ui _ui;
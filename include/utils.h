@@ -3,6 +3,8 @@
 
 #include <Arduino.h>
 
+#define TEMP_ONE 128 /**< Temperatures are kept in 1/128 C, the DS18B20 raw unit */
+
 namespace utils
 {
 
@@ -11,6 +13,127 @@ inline constexpr double mapd(double x, double in_min, double in_max, double out_
     return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
 }
 
+/**
+ * @brief Converts @a tenths of a degree into 1/TEMP_ONE C, rounded
+ */
+inline constexpr int16_t fromTenths(int tenths)
+{
+    return (tenths * (long)TEMP_ONE + (tenths < 0 ? -5 : 5)) / 10;
+}
+
+/**
+ * @brief Converts @a raw 1/TEMP_ONE C into tenths of a degree, rounded
+ */
+inline constexpr int toTenths(int16_t raw)
+{
+    return (raw * 10L + (raw < 0 ? -TEMP_ONE/2 : TEMP_ONE/2)) / TEMP_ONE;
+}
+
+/**
+ * @brief Divides @a num by @a den, a positive number, rounding to the nearest
+ */
+inline constexpr long divRound(long num, int den)
+{
+    return (num + (num < 0 ? -den/2 : den/2)) / den;
+}
+
+/**
+ * @brief Converts @a raw 1/TEMP_ONE C into degrees, for the few computations
+ * that are not worth doing in fixed point.
+ */
+inline float toCelsius(int16_t raw)
+{
+    return raw / (float)TEMP_ONE;
+}
+
+/**
+ * @brief Converts @a raw 1/TEMP_ONE C into hundredths of a degree, rounded
+ */
+inline constexpr int toHundredths(int16_t raw)
+{
+    return (raw * 100L + (raw < 0 ? -TEMP_ONE/2 : TEMP_ONE/2)) / TEMP_ONE;
+}
+
+/**
+ * @brief Prints @a v, a number of 1/10^@a decimals, as a decimal number,
+ * without going through float.
+ */
+inline void printFixed(Print& out, long v, uint8_t decimals)
+{
+    if(v < 0)
+    {
+        out.print('-');
+        v = -v;
+    }
+
+    long one = 1;
+    for(uint8_t i = 0; i < decimals; i++)
+        one *= 10;
+
+    out.print(v / one);
+    out.print('.');
+
+    for(one /= 10; one; one /= 10)
+        out.print((char)('0' + v / one % 10));
+}
+
+/**
+ * @brief Parses @a s, a decimal number such as "-1.25", into @a v, a number of
+ * 1/10^@a decimals. Decimals beyond those are ignored. Returns false if @a s
+ * is not a number or is too large.
+ */
+inline bool parseFixed(const char* s, uint8_t decimals, long& v)
+{
+    bool negative = *s == '-';
+    if(*s == '-' || *s == '+')
+        s++;
+
+    long    n      = 0;
+    uint8_t taken  = 0;
+    bool    point  = false;
+    bool    digits = false;
+
+    for(; *s; s++)
+    {
+        if(*s == '.' && !point)
+        {
+            point = true;
+            continue;
+        }
+
+        if(*s < '0' || *s > '9')
+            return false;
+
+        digits = true;
+        if(point && taken == decimals)
+            continue;
+
+        if(n > 10000000L)
+            return false;
+
+        n = n * 10 + (*s - '0');
+        if(point)
+            taken++;
+    }
+
+    if(!digits)
+        return false;
+
+    for(; taken < decimals; taken++)
+        n *= 10;
+
+    v = negative ? -n : n;
+    return true;
+}
+
+/**
+ * @brief Prints @a tenths of a degree as a decimal number
+ */
+inline void printTenths(Print& out, int tenths)
+{
+    printFixed(out, tenths, 1);
+}
+
 inline void invert(int pin)
 {
     int s = digitalRead(pin);
@@ -0,0 +1,144 @@
+#include "Adafruit_GFX.h"
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+{
+    for(int16_t i = 0; i < h; i++)
+        drawPixel(x, y + i, color);
+}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+{
+    for(int16_t i = 0; i < w; i++)
+        drawPixel(x + i, y, color);
+}
+
+void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color)
+{
+    int16_t dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int16_t dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int16_t err = dx + dy;
+
+    for(;;)
+    {
+        drawPixel(x0, y0, color);
+        if(x0 == x1 && y0 == y1)
+            break;
+
+        int16_t e2 = 2 * err;
+        if(e2 >= dy) { err += dy; x0 += sx; }
+        if(e2 <= dx) { err += dx; y0 += sy; }
+    }
+}
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, y + h - 1, w, color);
+    drawFastVLine(x, y, h, color);
+    drawFastVLine(x + w - 1, y, h, color);
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+    for(int16_t i = x; i < x + w; i++)
+        drawFastVLine(i, y, h, color);
+}
+
+void Adafruit_GFX::fillScreen(uint16_t color)
+{
+    fillRect(0, 0, _width, _height, color);
+}
+
+void Adafruit_GFX::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
+{
+    int16_t f = 1 - r;
+    int16_t ddF_x = 1;
+    int16_t ddF_y = -2 * r;
+    int16_t x = 0;
+    int16_t y = r;
+
+    drawPixel(x0, y0 + r, color);
+    drawPixel(x0, y0 - r, color);
+    drawPixel(x0 + r, y0, color);
+    drawPixel(x0 - r, y0, color);
+
+    while(x < y)
+    {
+        if(f >= 0)
+        {
+            y--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+        x++;
+        ddF_x += 2;
+        f += ddF_x;
+
+        drawPixel(x0 + x, y0 + y, color);
+        drawPixel(x0 - x, y0 + y, color);
+        drawPixel(x0 + x, y0 - y, color);
+        drawPixel(x0 - x, y0 - y, color);
+        drawPixel(x0 + y, y0 + x, color);
+        drawPixel(x0 - y, y0 + x, color);
+        drawPixel(x0 + y, y0 - x, color);
+        drawPixel(x0 - y, y0 - x, color);
+    }
+}
+
+void Adafruit_GFX::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[],
+                              int16_t w, int16_t h, uint16_t color)
+{
+    int16_t byteWidth = (w + 7) / 8;
+    uint8_t b = 0;
+
+    for(int16_t j = 0; j < h; j++, y++)
+    {
+        for(int16_t i = 0; i < w; i++)
+        {
+            if(i & 7)
+                b <<= 1;
+            else
+                b = pgm_read_byte(&bitmap[j * byteWidth + i / 8]);
+
+            if(b & 0x80)
+                drawPixel(x + i, y, color);
+        }
+    }
+}
+
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+                            uint16_t, uint8_t size_x, uint8_t size_y)
+{
+    if(c == ' ')
+        return;
+
+    for(int8_t i = 0; i < 5; i++)
+    {
+        uint8_t line = static_cast<uint8_t>((c * 37u + i * 101u) ^ (c >> 2)) & 0x7F;
+        for(int8_t j = 0; j < 8; j++, line >>= 1)
+            if(line & 1)
+                fillRect(x + i * size_x, y + j * size_y, size_x, size_y, color);
+    }
+}
+
+size_t Adafruit_GFX::write(uint8_t c)
+{
+    if(c == '\n')
+    {
+        _cursorX = 0;
+        _cursorY += _sizeY * 8;
+    }
+    else if(c != '\r')
+    {
+        if(_wrap && (_cursorX + _sizeX * 6) > _width)
+        {
+            _cursorX = 0;
+            _cursorY += _sizeY * 8;
+        }
+
+        drawChar(_cursorX, _cursorY, c, _textColor, _textColor, _sizeX, _sizeY);
+        _cursorX += _sizeX * 6;
+    }
+
+    return 1;
+}
@@ -0,0 +1,59 @@
+#ifndef ADAFRUIT_GFX_H
+#define ADAFRUIT_GFX_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Subset of the Adafruit GFX canvas used by the firmware.
+ *
+ * The text is not rendered with the real font: each glyph is a 5x7 pattern
+ * derived from its code so different text still produces different pixels.
+ */
+class Adafruit_GFX : public Print
+{
+public:
+    Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+    virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void fillScreen(uint16_t color);
+    void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+    void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[],
+                    int16_t w, int16_t h, uint16_t color);
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+                  uint16_t bg, uint8_t size_x, uint8_t size_y);
+
+    void setCursor(int16_t x, int16_t y) { _cursorX = x; _cursorY = y; }
+    void setTextSize(uint8_t s) { setTextSize(s, s); }
+    void setTextSize(uint8_t sx, uint8_t sy) { _sizeX = sx ? sx : 1; _sizeY = sy ? sy : 1; }
+    void setTextColor(uint16_t c) { _textColor = c; }
+    void setTextWrap(bool w) { _wrap = w; }
+    void cp437(bool x = true) { _cp437 = x; }
+
+    int16_t getCursorX() const { return _cursorX; }
+    int16_t getCursorY() const { return _cursorY; }
+    int16_t width()  const { return _width; }
+    int16_t height() const { return _height; }
+
+    using Print::write;
+    size_t write(uint8_t c) override;
+
+protected:
+    int16_t  _width;
+    int16_t  _height;
+    int16_t  _cursorX   = 0;
+    int16_t  _cursorY   = 0;
+    uint8_t  _sizeX     = 1;
+    uint8_t  _sizeY     = 1;
+    uint16_t _textColor = 1;
+    bool     _wrap      = true;
+    bool     _cp437     = false;
+};
+
+#endif // ADAFRUIT_GFX_H
@@ -0,0 +1,6 @@
+#ifndef ADAFRUIT_I2CDEVICE_H
+#define ADAFRUIT_I2CDEVICE_H
+
+#include <Wire.h>
+
+#endif // ADAFRUIT_I2CDEVICE_H
@@ -0,0 +1,142 @@
+#include "Adafruit_SSD1306.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define WIRE_MAX BUFFER_LENGTH
+
+Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi, int8_t,
+                                   uint32_t clkDuring, uint32_t clkAfter) :
+    Adafruit_GFX(w, h),
+    wire(twi),
+    wireClk(clkDuring),
+    restoreClk(clkAfter)
+{}
+
+Adafruit_SSD1306::~Adafruit_SSD1306()
+{
+    free(buffer);
+}
+
+bool Adafruit_SSD1306::begin(uint8_t, uint8_t addr, bool, bool)
+{
+    if(!buffer && !(buffer = static_cast<uint8_t*>(malloc(_width * ((_height + 7) / 8)))))
+        return false;
+
+    clearDisplay();
+
+    if(addr)
+        i2caddr = addr;
+
+    wire->setClock(wireClk);
+
+    static const uint8_t init[] = {
+        SSD1306_DISPLAYOFF, 0xD5, 0x80, 0xA8, static_cast<uint8_t>(_height - 1),
+        0xD3, 0x00, 0x40, 0x8D, 0x14, SSD1306_MEMORYMODE, 0x00, 0xA1, 0xC8,
+        0xDA, 0x02, 0x81, 0x8F, 0xD9, 0xF1, 0xDB, 0x40, 0xA4, 0xA6, 0x2E,
+        SSD1306_DISPLAYON
+    };
+    ssd1306_commandList(init, sizeof(init));
+
+    wire->setClock(restoreClk);
+
+    return true;
+}
+
+void Adafruit_SSD1306::display()
+{
+    wire->setClock(wireClk);
+
+    static const uint8_t dlist1[] = {SSD1306_PAGEADDR, 0, 0xFF, SSD1306_COLUMNADDR};
+    ssd1306_commandList(dlist1, sizeof(dlist1));
+    ssd1306_command1(0);
+    ssd1306_command1(_width - 1);
+
+    uint16_t count = _width * ((_height + 7) / 8);
+    uint8_t* ptr = buffer;
+
+    wire->beginTransmission(i2caddr);
+    wire->write(static_cast<uint8_t>(0x40));
+    uint16_t bytesOut = 1;
+
+    while(count--)
+    {
+        if(bytesOut >= WIRE_MAX)
+        {
+            wire->endTransmission();
+            wire->beginTransmission(i2caddr);
+            wire->write(static_cast<uint8_t>(0x40));
+            bytesOut = 1;
+        }
+        wire->write(*ptr++);
+        bytesOut++;
+    }
+    wire->endTransmission();
+
+    wire->setClock(restoreClk);
+}
+
+void Adafruit_SSD1306::clearDisplay()
+{
+    memset(buffer, 0, _width * ((_height + 7) / 8));
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+    if(x < 0 || x >= _width || y < 0 || y >= _height)
+        return;
+
+    uint8_t& b = buffer[x + (y / 8) * _width];
+    uint8_t bit = 1 << (y & 7);
+
+    switch(color)
+    {
+    case SSD1306_WHITE:   b |=  bit; break;
+    case SSD1306_BLACK:   b &= ~bit; break;
+    case SSD1306_INVERSE: b ^=  bit; break;
+    }
+}
+
+bool Adafruit_SSD1306::getPixel(int16_t x, int16_t y)
+{
+    if(x < 0 || x >= _width || y < 0 || y >= _height)
+        return false;
+
+    return buffer[x + (y / 8) * _width] & (1 << (y & 7));
+}
+
+void Adafruit_SSD1306::ssd1306_command(uint8_t c)
+{
+    wire->setClock(wireClk);
+    ssd1306_command1(c);
+    wire->setClock(restoreClk);
+}
+
+void Adafruit_SSD1306::ssd1306_command1(uint8_t c)
+{
+    wire->beginTransmission(i2caddr);
+    wire->write(static_cast<uint8_t>(0x00));
+    wire->write(c);
+    wire->endTransmission();
+}
+
+void Adafruit_SSD1306::ssd1306_commandList(const uint8_t* c, uint8_t n)
+{
+    wire->beginTransmission(i2caddr);
+    wire->write(static_cast<uint8_t>(0x00));
+    uint16_t bytesOut = 1;
+
+    while(n--)
+    {
+        if(bytesOut >= WIRE_MAX)
+        {
+            wire->endTransmission();
+            wire->beginTransmission(i2caddr);
+            wire->write(static_cast<uint8_t>(0x00));
+            bytesOut = 1;
+        }
+        wire->write(*c++);
+        bytesOut++;
+    }
+    wire->endTransmission();
+}
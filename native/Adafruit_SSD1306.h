@@ -0,0 +1,58 @@
+#ifndef ADAFRUIT_SSD1306_H
+#define ADAFRUIT_SSD1306_H
+
+#include <Adafruit_GFX.h>
+#include <Wire.h>
+
+#define SSD1306_128_32
+
+#define SSD1306_LCDWIDTH  128
+#define SSD1306_LCDHEIGHT 32
+
+#define SSD1306_BLACK   0
+#define SSD1306_WHITE   1
+#define SSD1306_INVERSE 2
+
+#define SSD1306_MEMORYMODE  0x20
+#define SSD1306_COLUMNADDR  0x21
+#define SSD1306_PAGEADDR    0x22
+#define SSD1306_DISPLAYOFF  0xAE
+#define SSD1306_DISPLAYON   0xAF
+#define SSD1306_SWITCHCAPVCC 0x02
+
+/**
+ * @brief Framebuffer-only SSD1306 driver. It speaks the same I2C protocol as
+ * the Adafruit library so the bus cost and the panel content are realistic.
+ */
+class Adafruit_SSD1306 : public Adafruit_GFX
+{
+public:
+    Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi, int8_t rst_pin = -1,
+                     uint32_t clkDuring = 400000UL, uint32_t clkAfter = 100000UL);
+    ~Adafruit_SSD1306();
+
+    bool begin(uint8_t switchvcc = SSD1306_SWITCHCAPVCC, uint8_t i2caddr = 0,
+               bool reset = true, bool periphBegin = true);
+
+    void display();
+    void clearDisplay();
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    bool getPixel(int16_t x, int16_t y);
+
+    void ssd1306_command(uint8_t c);
+
+    uint8_t* getBuffer() { return buffer; }
+
+protected:
+    void ssd1306_command1(uint8_t c);
+    void ssd1306_commandList(const uint8_t* c, uint8_t n);
+
+    TwoWire* wire;
+    uint8_t* buffer = nullptr;
+    uint8_t  i2caddr = 0x3C;
+    uint32_t wireClk;
+    uint32_t restoreClk;
+};
+
+#endif // ADAFRUIT_SSD1306_H
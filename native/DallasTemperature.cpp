@@ -0,0 +1,145 @@
+#include "DallasTemperature.h"
+
+#include <math.h>
+
+#include "sim.h"
+
+void DallasTemperature::begin()
+{
+    sim::oneWireTransfer(2 + 9 * sim::sensorCount());
+}
+
+uint8_t DallasTemperature::getDeviceCount()
+{
+    return sim::sensorCount();
+}
+
+/**
+ * Simulated ROM codes are 28 <index> 00 00 00 00 00 <crc>
+ */
+bool DallasTemperature::getAddress(uint8_t* addr, uint8_t index)
+{
+    sim::oneWireTransfer(8 * (index + 1));
+
+    if(index >= sim::sensorCount())
+        return false;
+
+    addr[0] = 0x28;
+    addr[1] = index;
+    for(uint8_t i = 2; i < 7; i++)
+        addr[i] = 0;
+    addr[7] = static_cast<uint8_t>(0x5A ^ index);
+
+    return true;
+}
+
+bool DallasTemperature::isConnected(const uint8_t* addr)
+{
+    sim::oneWireTransfer(1 + 8 + 1 + 9);
+    return addr[0] == 0x28 && sim::sensorPresent(addr[1]);
+}
+
+/**
+ * The library writes the scratchpad of each device found by begin()
+ */
+void DallasTemperature::setResolution(uint8_t bits)
+{
+    _bits = bits < 9 ? 9 : (bits > 12 ? 12 : bits);
+
+    for(uint8_t i = 0; i < sim::sensorCount(); i++)
+    {
+        sim::oneWireTransfer(1 + 8 + 4);
+
+        if(_autoSave)
+        {
+            sim::oneWireTransfer(1 + 8 + 1);
+            sim::advance(20000);
+        }
+    }
+}
+
+/**
+ * Writes the scratchpad, then copies it to the sensor EEPROM unless told not
+ * to, which the library waits 20ms for.
+ */
+bool DallasTemperature::setResolution(const uint8_t* addr, uint8_t bits, bool)
+{
+    _bits = bits < 9 ? 9 : (bits > 12 ? 12 : bits);
+    sim::oneWireTransfer(1 + 8 + 4);
+
+    if(_autoSave)
+    {
+        sim::oneWireTransfer(1 + 8 + 1);
+        sim::advance(20000);
+    }
+
+    return isConnected(addr);
+}
+
+uint8_t DallasTemperature::getResolution()
+{
+    return _bits;
+}
+
+/**
+ * A single read slot, no reset
+ */
+bool DallasTemperature::isConversionComplete()
+{
+    sim::advance(65);
+    return sim::now() >= _ready;
+}
+
+void DallasTemperature::requestTemperatures()
+{
+    sim::oneWireTransfer(2);
+    _ready = sim::now() + millisToWaitForConversion(_bits) * 1000ull;
+
+    if(_wait)
+        sim::advance(_ready - sim::now());
+}
+
+bool DallasTemperature::requestTemperaturesByAddress(const uint8_t* addr)
+{
+    sim::oneWireTransfer(1 + 8 + 1);
+    _ready = sim::now() + millisToWaitForConversion(_bits) * 1000ull;
+
+    if(_wait)
+        sim::advance(_ready - sim::now());
+
+    return sim::sensorPresent(addr[1]);
+}
+
+/**
+ * Raw value in 1/128 C, truncated to the configured resolution
+ */
+int16_t DallasTemperature::getTemp(const uint8_t* addr)
+{
+    sim::oneWireTransfer(1 + 8 + 1 + 9);
+
+    if(addr[0] != 0x28 || !sim::sensorPresent(addr[1]))
+        return DEVICE_DISCONNECTED_RAW;
+
+    int16_t raw = static_cast<int16_t>(floorf(sim::sensorTemperature(addr[1]) * 16)) << 3;
+    return raw & ~((1 << (3 + 12 - _bits)) - 1);
+}
+
+float DallasTemperature::getTempC(const uint8_t* addr)
+{
+    int16_t raw = getTemp(addr);
+    if(raw <= DEVICE_DISCONNECTED_RAW)
+        return DEVICE_DISCONNECTED_C;
+
+    return raw * 0.0078125f;
+}
+
+int16_t DallasTemperature::millisToWaitForConversion(uint8_t bits)
+{
+    switch(bits)
+    {
+    case 9:  return 94;
+    case 10: return 188;
+    case 11: return 375;
+    default: return 750;
+    }
+}
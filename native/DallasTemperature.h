@@ -0,0 +1,55 @@
+#ifndef DALLAS_TEMPERATURE_H
+#define DALLAS_TEMPERATURE_H
+
+#include <stdint.h>
+
+#include <OneWire.h>
+
+#define DEVICE_DISCONNECTED_C   -127
+#define DEVICE_DISCONNECTED_RAW -7040
+
+typedef uint8_t DeviceAddress[8];
+
+/**
+ * @brief DS18B20 driver talking to the simulated sensors. Every call costs its
+ * OneWire bus time and the conversion takes as long as the resolution says.
+ */
+class DallasTemperature
+{
+public:
+    explicit DallasTemperature(OneWire* one) : _one(one) {}
+
+    void begin();
+
+    uint8_t getDeviceCount();
+    bool getAddress(uint8_t* addr, uint8_t index);
+    bool isConnected(const uint8_t* addr);
+
+    void setResolution(uint8_t bits);
+    bool setResolution(const uint8_t* addr, uint8_t bits,
+                       bool skipGlobalBitResolutionCalculation = false);
+    uint8_t getResolution();
+
+    void setAutoSaveScratchPad(bool flag) { _autoSave = flag; }
+    void setWaitForConversion(bool flag) { _wait = flag; }
+    void setCheckForConversion(bool flag) { _check = flag; }
+
+    bool isConversionComplete();
+    void requestTemperatures();
+    bool requestTemperaturesByAddress(const uint8_t* addr);
+
+    int16_t getTemp(const uint8_t* addr);
+    float getTempC(const uint8_t* addr);
+
+    static int16_t millisToWaitForConversion(uint8_t bits);
+
+private:
+    OneWire* _one;
+    uint8_t  _bits = 12;
+    bool     _wait = true;
+    bool     _check = true;
+    bool     _autoSave = true;
+    uint64_t _ready = 0;
+};
+
+#endif // DALLAS_TEMPERATURE_H
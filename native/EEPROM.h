@@ -0,0 +1,91 @@
+#ifndef EEPROM_H
+#define EEPROM_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sim.h"
+
+#define EEPROM_SIZE 256
+
+/**
+ * @brief In-memory EEPROM. Erased cells read 0xFF and every byte actually
+ * written costs the time of an erase/write cycle.
+ */
+class EEPROMClass
+{
+public:
+    EEPROMClass()
+    {
+        memset(_data, 0xFF, sizeof(_data));
+    }
+
+    uint8_t read(int idx) const
+    {
+        return _data[idx % EEPROM_SIZE];
+    }
+
+    void write(int idx, uint8_t val)
+    {
+        _data[idx % EEPROM_SIZE] = val;
+        sim::eepromWrite();
+    }
+
+    void update(int idx, uint8_t val)
+    {
+        if(read(idx) != val)
+            write(idx, val);
+    }
+
+    void load(const char* path)
+    {
+        FILE* f = path ? fopen(path, "rb") : nullptr;
+        if(f)
+        {
+            if(fread(_data, 1, sizeof(_data), f) != sizeof(_data))
+                memset(_data, 0xFF, sizeof(_data));
+            fclose(f);
+        }
+    }
+
+    void save(const char* path) const
+    {
+        FILE* f = path ? fopen(path, "wb") : nullptr;
+        if(f)
+        {
+            fwrite(_data, 1, sizeof(_data), f);
+            fclose(f);
+        }
+    }
+
+    uint16_t length() const
+    {
+        return EEPROM_SIZE;
+    }
+
+    template<typename T>
+    T& get(int idx, T& t) const
+    {
+        uint8_t* p = reinterpret_cast<uint8_t*>(&t);
+        for(unsigned int i = 0; i < sizeof(T); i++)
+            p[i] = read(idx + i);
+        return t;
+    }
+
+    template<typename T>
+    const T& put(int idx, const T& t)
+    {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&t);
+        for(unsigned int i = 0; i < sizeof(T); i++)
+            update(idx + i, p[i]);
+        return t;
+    }
+
+private:
+    uint8_t _data[EEPROM_SIZE];
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // EEPROM_H
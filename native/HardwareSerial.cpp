@@ -0,0 +1,31 @@
+#include "HardwareSerial.h"
+
+#include "sim.h"
+
+HardwareSerial Serial;
+
+void HardwareSerial::begin(unsigned long baud)
+{
+    sim::serialBegin(baud);
+}
+
+int HardwareSerial::available()
+{
+    return static_cast<int>(sim::serialAvailable());
+}
+
+int HardwareSerial::read()
+{
+    return sim::serialRead();
+}
+
+int HardwareSerial::availableForWrite()
+{
+    return static_cast<int>(sim::serialRoom());
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    sim::serialWrite(c);
+    return 1;
+}
@@ -0,0 +1,34 @@
+#ifndef HARDWARESERIAL_H
+#define HARDWARESERIAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Print.h"
+
+#define SERIAL_TX_BUFFER_SIZE 64
+
+/**
+ * @brief The UART wired to the USB bridge. As in the core, bytes go through a
+ * SERIAL_TX_BUFFER_SIZE buffer emptied at the baud rate, and write() waits for
+ * room when it is full. Received bytes wait in a buffer of the same size.
+ */
+class HardwareSerial : public Print
+{
+public:
+    void begin(unsigned long baud);
+    void end() {}
+
+    int available();
+    int read();
+    int availableForWrite();
+
+    size_t write(uint8_t c) override;
+    using Print::write;
+
+    operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif // HARDWARESERIAL_H
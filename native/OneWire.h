@@ -0,0 +1,18 @@
+#ifndef ONEWIRE_H
+#define ONEWIRE_H
+
+#include <stdint.h>
+
+/**
+ * @brief The bus itself, the transfers are accounted by DallasTemperature.
+ */
+class OneWire
+{
+public:
+    explicit OneWire(uint8_t pin) : _pin(pin) {}
+
+private:
+    uint8_t _pin;
+};
+
+#endif // ONEWIRE_H
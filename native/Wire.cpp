@@ -0,0 +1,35 @@
+#include "Wire.h"
+
+#include "sim.h"
+
+TwoWire Wire;
+
+void TwoWire::beginTransmission(uint8_t addr)
+{
+    _addr = addr;
+    _length = 0;
+}
+
+size_t TwoWire::write(uint8_t b)
+{
+    if(_length >= BUFFER_LENGTH)
+        return 0;
+
+    _buffer[_length++] = b;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t len)
+{
+    size_t n = 0;
+    while(len-- && write(*data++))
+        n++;
+    return n;
+}
+
+uint8_t TwoWire::endTransmission(bool)
+{
+    sim::i2cWrite(_addr, _buffer, _length, _clock);
+    _length = 0;
+    return 0;
+}
@@ -0,0 +1,33 @@
+#ifndef WIRE_H
+#define WIRE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BUFFER_LENGTH 128
+
+/**
+ * @brief Master-only I2C bus. Transmissions are handed to the simulated
+ * devices when they end and cost their transfer time on the virtual clock.
+ */
+class TwoWire
+{
+public:
+    void begin() {}
+    void setClock(unsigned long clock) { _clock = clock; }
+
+    void beginTransmission(uint8_t addr);
+    size_t write(uint8_t b);
+    size_t write(const uint8_t* data, size_t len);
+    uint8_t endTransmission(bool stop = true);
+
+private:
+    unsigned long _clock = 100000;
+    uint8_t _addr = 0;
+    uint8_t _buffer[BUFFER_LENGTH];
+    size_t  _length = 0;
+};
+
+extern TwoWire Wire;
+
+#endif // WIRE_H
@@ -0,0 +1,91 @@
+#include <Arduino.h>
+
+#include "sim.h"
+
+unsigned long millis()
+{
+    sim::advance(1);
+    return sim::now() / 1000;
+}
+
+unsigned long micros()
+{
+    sim::advance(1);
+    return sim::now();
+}
+
+void delay(unsigned long ms)
+{
+    sim::advance(ms * 1000ull);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    sim::advance(us);
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if(mode == INPUT_PULLUP && !sim::readPin(pin))
+        sim::drivePin(pin, HIGH);
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    sim::writePin(pin, val);
+}
+
+int digitalRead(uint8_t pin)
+{
+    return sim::readPin(pin);
+}
+
+/**
+ * Same semantic as the Arduino core: waits for the pin to reach @a state, then
+ * measures how long it stays there. Returns 0 on timeout.
+ */
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout)
+{
+    uint64_t start = sim::now();
+
+    while(sim::readPin(pin) == state)
+    {
+        if(sim::now() - start >= timeout) return 0;
+        sim::advance(1);
+    }
+
+    while(sim::readPin(pin) != state)
+    {
+        if(sim::now() - start >= timeout) return 0;
+        sim::advance(1);
+    }
+
+    uint64_t begin = sim::now();
+    while(sim::readPin(pin) == state)
+    {
+        if(sim::now() - start >= timeout) return 0;
+        sim::advance(1);
+    }
+
+    return static_cast<unsigned long>(sim::now() - begin);
+}
+
+void attachInterrupt(uint8_t pin, void (*userFunc)(void), int mode)
+{
+    sim::attachInterrupt(pin, userFunc, mode);
+}
+
+void detachInterrupt(uint8_t pin)
+{
+    sim::detachInterrupt(pin);
+}
+
+void interrupts()
+{
+    sim::setInterruptsEnabled(true);
+}
+
+void noInterrupts()
+{
+    sim::setInterruptsEnabled(false);
+}
@@ -0,0 +1,142 @@
+#include "hal.h"
+#include "sim.h"
+#include "pins.h"
+#include "triac.h"
+
+namespace
+{
+
+bool     _firingRunning = false;
+bool     _hardwareGate  = true;
+uint64_t _firingStart   = 0;
+uint16_t _edgeTicks     = 0;
+uint64_t _tickUs        = 0;
+void   (*_tickHandler)() = nullptr;
+
+/**
+ * The RTC overflow, with the same drift every period
+ */
+void tickOverflow()
+{
+    sim::schedule(sim::RtcOverflow, sim::now() + _tickUs, tickOverflow);
+    sim::raise(_tickHandler);
+}
+
+void firingInterrupt()
+{
+    Triac::timeout();
+}
+
+/**
+ * Single-shot mode: the counter stops at CCMP. The gate pulse is either
+ * produced by the peripherals, without any CPU time, or by the interrupt.
+ */
+void firingMatch()
+{
+    _firingRunning = false;
+
+    if(!_hardwareGate)
+    {
+        sim::raise(firingInterrupt);
+        return;
+    }
+
+    sim::writePin(TRIAC_PIN, 1);
+    sim::writePin(TRIAC_PIN, 0);
+}
+
+/**
+ * The counter is clocked by the TCA prescaler, it moves on the next multiple
+ * of FIRING_TICK_US after being started.
+ */
+void startCounting(uint16_t ticks)
+{
+    _firingRunning = true;
+    _firingStart   = sim::now() - sim::now() % FIRING_TICK_US;
+    sim::schedule(sim::FiringTimer,
+                  _firingStart + (ticks + 1ull) * FIRING_TICK_US,
+                  firingMatch);
+}
+
+void edgeEvent()
+{
+    if(!_firingRunning)
+        startCounting(_edgeTicks);
+}
+
+}
+
+void hal::setupFiringTimer()
+{
+    _firingRunning = false;
+    setHardwareGate(true);
+}
+
+void hal::setHardwareGate(bool enabled)
+{
+    _hardwareGate = enabled;
+}
+
+void hal::setEdgeStart(bool enabled)
+{
+    stopFiringTimer();
+    sim::routeEvent(INTER_PIN, enabled ? edgeEvent : nullptr);
+}
+
+void hal::setFiringTicks(uint16_t ticks)
+{
+    _edgeTicks = ticks;
+}
+
+void hal::startFiringTimer(uint16_t ticks)
+{
+    startCounting(ticks);
+}
+
+void hal::stopFiringTimer()
+{
+    _firingRunning = false;
+    sim::cancel(sim::FiringTimer);
+}
+
+bool hal::isFiringTimerRunning()
+{
+    return _firingRunning;
+}
+
+long hal::firingLatency()
+{
+    if(!_firingRunning)
+        return -1;
+
+    uint64_t now   = sim::now();
+    uint64_t ticks = (now - _firingStart) / FIRING_TICK_US;
+
+    return static_cast<long>(now - sim::lastRise(INTER_PIN)) - static_cast<long>(ticks * FIRING_TICK_US);
+}
+
+void hal::setGate(bool on)
+{
+    if(!_hardwareGate)
+        sim::writePin(TRIAC_PIN, on);
+}
+
+bool hal::eepromBusy()
+{
+    return sim::eepromBusy();
+}
+
+void hal::idle()
+{
+    sim::idle();
+}
+
+/**
+ * The RTC counts a 32.768kHz oscillator, the period is rounded to its ticks
+ */
+void hal::setupTick(uint16_t ms, void (*handler)())
+{
+    _tickHandler = handler;
+    _tickUs      = (ms * 32768ull / 1000) * 1000000ull / 32768;
+    sim::schedule(sim::RtcOverflow, sim::now() + _tickUs, tickOverflow);
+}
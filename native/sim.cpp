@@ -0,0 +1,874 @@
+#include "sim.h"
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pins.h"
+
+#define SIM_PINS        32
+#define SIM_MAX_PENDING 8
+#define SIM_MAX_SENSORS 8
+#define SIM_MAX_PRESSES 64
+#define SIM_PRESS_US    80000
+#define SIM_BOUNCE_US   300   // between the contact bounces of a press
+#define SIM_BOUNCES     2     // extra edges a press makes before settling
+#define SIM_SERIAL_FIFO 64
+#define SIM_MAX_COMMANDS 16
+#define SIM_COMMAND_LEN  64
+#define SIM_NEVER       UINT64_MAX
+
+namespace sim
+{
+
+namespace
+{
+
+struct Scheduled
+{
+    uint64_t when = SIM_NEVER;
+    Handler  handler = nullptr;
+};
+
+struct Interrupt
+{
+    Handler handler = nullptr;
+    int     mode = 0;
+    Handler event = nullptr;
+};
+
+// Clock and interrupt controller ---------------------------------------------
+uint64_t  _now = 0;
+Scheduled _events[EventCount];
+Interrupt _interrupts[SIM_PINS];
+Handler   _pending[SIM_MAX_PENDING];
+uint8_t   _pendingCount = 0;
+bool      _interruptsEnabled = true;
+bool      _inInterrupt = false;
+int       _pins[SIM_PINS] = {0};
+uint64_t  _rises[SIM_PINS] = {0};
+
+// Mains and plant -------------------------------------------------------------
+enum MainsPhase { PulseRising, TrueZero, PulseFalling };
+
+float    _halfPeriod  = 10000;   // us
+float    _pulseWidth  = 600;     // us
+float    _ambient     = 20;      // C
+float    _heaterMax   = 150;     // W
+float    _resistance  = 0.25f;   // K/W
+float    _capacity    = 2000;    // J/K
+float    _sensorLag   = 20;      // s
+float    _enclosure   = 20;      // C
+float    _sensor      = 20;      // C
+float    _lastPower   = 0;       // 0..1
+uint64_t _zero        = 0;
+uint8_t  _phase       = PulseRising;
+float    _fireAngle   = 2;       // fraction of the current half-cycle, >1 = not fired
+float    _glitchRate  = 0;       // spurious detector pulses per second
+uint8_t  _sensorCount = 1;
+uint64_t _sensorDrop  = SIM_NEVER; // the last sensor stops answering from then
+uint32_t _seed        = 0x1234567;
+
+// Scripted button presses ----------------------------------------------------------
+struct Press
+{
+    uint64_t when;
+    uint64_t hold;
+    uint8_t  pin;
+};
+
+Press   _presses[SIM_MAX_PRESSES];
+uint8_t _pressCount = 0;
+uint8_t _nextPress  = 0;
+uint8_t _pressEdges = 0;  // edges the current press made so far
+
+// Statistics -------------------------------------------------------------------
+unsigned long _i2cBytes = 0;
+uint64_t      _idleUs   = 0;
+unsigned long _eepromWrites = 0;
+uint64_t      _eepromBusy   = 0;
+
+// Serial port -------------------------------------------------------------------
+uint8_t  _txFifo[SIM_SERIAL_FIFO];
+uint8_t  _txHead   = 0;
+uint8_t  _txCount  = 0;
+uint64_t _txByteUs = 0;        // to send a byte, on the line or to the host
+uint64_t _txNext   = 0;        // when the byte at the head is sent
+FILE*    _serialOut = nullptr; // where the host stores what it receives
+unsigned long _serialBytes = 0;
+
+// Lines the host sends, one byte after the other at the baud rate
+struct Command
+{
+    uint64_t when;
+    char     text[SIM_COMMAND_LEN];
+};
+
+Command  _commands[SIM_MAX_COMMANDS];
+uint8_t  _commandCount = 0;
+uint8_t  _nextCommand  = 0;
+uint8_t  _commandSent  = 0;    // bytes of the next command already received
+uint8_t  _rxFifo[SIM_SERIAL_FIFO];
+uint8_t  _rxHead   = 0;
+uint8_t  _rxCount  = 0;
+uint64_t _rxByteUs = 0;
+unsigned long _rxLost = 0;
+
+// SSD1306 panel -----------------------------------------------------------------
+uint8_t _ram[8 * 128];
+uint8_t _cmd = 0;
+uint8_t _args[8];
+uint8_t _argCount = 0;
+uint8_t _argNeeded = 0;
+uint8_t _colStart = 0, _colEnd = 127, _col = 0;
+uint8_t _pageStart = 0, _pageEnd = 7, _page = 0;
+
+float envf(const char* name, float def)
+{
+    const char* v = getenv(name);
+    return v ? static_cast<float>(atof(v)) : def;
+}
+
+float noise(float amplitude)
+{
+    _seed = _seed * 1103515245u + 12345u;
+    return amplitude * ((static_cast<int>((_seed >> 16) & 0x7FFF) - 16384) / 16384.0f);
+}
+
+void deliver(Handler h)
+{
+    if(!_interruptsEnabled || _inInterrupt)
+    {
+        for(uint8_t i = 0; i < _pendingCount; i++)
+            if(_pending[i] == h)
+                return;
+
+        if(_pendingCount < SIM_MAX_PENDING)
+            _pending[_pendingCount++] = h;
+        return;
+    }
+
+    _inInterrupt = true;
+    h();
+    _inInterrupt = false;
+
+    while(_pendingCount && _interruptsEnabled)
+    {
+        Handler next = _pending[0];
+        memmove(_pending, _pending + 1, --_pendingCount * sizeof(Handler));
+
+        _inInterrupt = true;
+        next();
+        _inInterrupt = false;
+    }
+}
+
+/**
+ * Delivered power ratio of a half-cycle fired at @a angle (0..1 of the half
+ * period). Integral of sin^2 from the firing angle to pi.
+ */
+float phasePower(float angle)
+{
+    if(angle >= 1)
+        return 0;
+    if(angle <= 0)
+        return 1;
+
+    return 1 - angle + sinf(2 * M_PI * angle) / (2 * M_PI);
+}
+
+void settleHalfCycle()
+{
+    float dt = _halfPeriod / 1e6f;
+    _lastPower = readPin(RELAY_PIN) ? phasePower(_fireAngle) : 0;
+
+    float p = _lastPower * _heaterMax;
+    _enclosure += (p - (_enclosure - _ambient) / _resistance) * dt / _capacity;
+    _sensor    += (_enclosure - _sensor) * dt / _sensorLag;
+
+    _fireAngle = readPin(TRIAC_PIN) ? 0 : 2;
+}
+
+void mainsEdge()
+{
+    switch(_phase)
+    {
+    case PulseRising:
+        _phase = TrueZero;
+        schedule(MainsEdge, _zero, mainsEdge);
+        drivePin(INTER_PIN, HIGH);
+        break;
+
+    case TrueZero:
+        _phase = PulseFalling;
+        schedule(MainsEdge, _zero + static_cast<uint64_t>(_pulseWidth / 2 + noise(15)), mainsEdge);
+        settleHalfCycle();
+        break;
+
+    case PulseFalling:
+        _phase = PulseRising;
+        _zero += static_cast<uint64_t>(_halfPeriod);
+        schedule(MainsEdge, _zero - static_cast<uint64_t>(_pulseWidth / 2 + noise(15)), mainsEdge);
+        drivePin(INTER_PIN, LOW);
+        break;
+    }
+}
+
+/**
+ * A short spurious pulse on the zero crossing detector, as a noisy line or a
+ * switching load would produce.
+ */
+void glitch()
+{
+    if(readPin(INTER_PIN))
+        drivePin(INTER_PIN, LOW);
+    else
+    {
+        drivePin(INTER_PIN, HIGH);
+        schedule(Glitch, _now + 20, glitch);
+        return;
+    }
+
+    float gap = 2e6f / _glitchRate;
+    schedule(Glitch, _now + static_cast<uint64_t>(gap / 2 + noise(gap / 2)), glitch);
+}
+
+void gateFired()
+{
+    if(_phase == TrueZero)  // Pulse is high, the next zero has not been reached yet
+        return;
+
+    uint64_t last = _phase == PulseFalling ? _zero : _zero - static_cast<uint64_t>(_halfPeriod);
+    float angle = (_now - last) / _halfPeriod;
+    if(angle < _fireAngle)
+        _fireAngle = angle;
+}
+
+uint8_t commandArgs(uint8_t c)
+{
+    switch(c)
+    {
+    case 0x21: case 0x22: case 0xA3:
+        return 2;
+    case 0x26: case 0x27:
+        return 6;
+    case 0x29: case 0x2A:
+        return 5;
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+    case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+void panelCommand(uint8_t b)
+{
+    if(_argNeeded)
+    {
+        _args[_argCount++] = b;
+        if(_argCount < _argNeeded)
+            return;
+
+        _argNeeded = 0;
+        switch(_cmd)
+        {
+        case 0x21:
+            _colStart = _col = _args[0] & 0x7F;
+            _colEnd = _args[1] & 0x7F;
+            break;
+
+        case 0x22:
+            _pageStart = _page = _args[0] & 0x07;
+            _pageEnd = _args[1] & 0x07;
+            break;
+        }
+        return;
+    }
+
+    _cmd = b;
+    _argCount = 0;
+    _argNeeded = commandArgs(b);
+}
+
+void panelData(uint8_t b)
+{
+    _ram[_page * 128 + _col] = b;
+
+    if(_col++ >= _colEnd)
+    {
+        _col = _colStart;
+        if(_page++ >= _pageEnd)
+            _page = _pageStart;
+    }
+}
+
+/**
+ * Presses and releases the scripted buttons one after the other. The contacts
+ * bounce SIM_BOUNCES times when pressed, like real ones.
+ */
+void buttonPress()
+{
+    const Press& p = _presses[_nextPress];
+
+    if(_pressEdges <= SIM_BOUNCES)
+    {
+        bool settled = _pressEdges == SIM_BOUNCES;
+        schedule(ButtonPress, _now + (settled ? p.hold : SIM_BOUNCE_US), buttonPress);
+        drivePin(p.pin, _pressEdges++ % 2 ? HIGH : LOW);
+        return;
+    }
+
+    _pressEdges = 0;
+    if(++_nextPress < _pressCount)
+        schedule(ButtonPress, _presses[_nextPress].when, buttonPress);
+    drivePin(p.pin, HIGH);
+}
+
+/**
+ * SIM_BUTTONS is a list of <seconds>:<l|c|r>[*<seconds held>] separated by
+ * commas
+ */
+void parseButtons(const char* script)
+{
+    while(script && *script && _pressCount < SIM_MAX_PRESSES)
+    {
+        char* end;
+        double t = strtod(script, &end);
+        if(*end != ':')
+            break;
+
+        uint8_t pin = end[1] == 'l' ? SW1_PIN : (end[1] == 'c' ? SW2_PIN : SW3_PIN);
+        uint64_t hold = SIM_PRESS_US;
+        if(end[2] == '*')
+            hold = static_cast<uint64_t>(strtod(end + 3, nullptr) * 1e6);
+
+        _presses[_pressCount++] = {static_cast<uint64_t>(t * 1e6), hold, pin};
+
+        script = strchr(end, ',');
+        if(script)
+            script++;
+    }
+
+    if(_pressCount)
+        schedule(ButtonPress, _presses[0].when, buttonPress);
+}
+
+/**
+ * SIM_COMMANDS is a list of <seconds>:<line> separated by semicolons
+ */
+void parseCommands(const char* script)
+{
+    while(script && *script && _commandCount < SIM_MAX_COMMANDS)
+    {
+        char* end;
+        double t = strtod(script, &end);
+        if(*end != ':')
+            break;
+
+        const char* text = end + 1;
+        const char* next = strchr(text, ';');
+        size_t len = next ? static_cast<size_t>(next - text) : strlen(text);
+        if(len >= SIM_COMMAND_LEN)
+            len = SIM_COMMAND_LEN - 1;
+
+        Command& c = _commands[_commandCount++];
+        c.when = static_cast<uint64_t>(t * 1e6);
+        memcpy(c.text, text, len);
+        c.text[len] = 0;
+
+        script = next ? next + 1 : nullptr;
+    }
+}
+
+void begin()
+{
+    _halfPeriod  = 1e6f / (2 * envf("SIM_MAINS_HZ", 50));
+    _ambient     = envf("SIM_AMBIENT", 20);
+    _heaterMax   = envf("SIM_HEATER_W", 150);
+    _sensorCount = static_cast<uint8_t>(envf("SIM_SENSORS", 1));
+    _glitchRate  = envf("SIM_GLITCHES", 0);
+    _enclosure   = _ambient;
+
+    if(envf("SIM_SENSOR_DROP", 0) > 0)
+        _sensorDrop = static_cast<uint64_t>(envf("SIM_SENSOR_DROP", 0) * 1e6);
+    _sensor      = _ambient;
+
+    if(_sensorCount > SIM_MAX_SENSORS)
+        _sensorCount = SIM_MAX_SENSORS;
+
+    _zero = static_cast<uint64_t>(_halfPeriod);
+    schedule(MainsEdge, _zero - static_cast<uint64_t>(_pulseWidth / 2), mainsEdge);
+
+    if(_glitchRate > 0)
+        schedule(Glitch, static_cast<uint64_t>(1e6f / _glitchRate), glitch);
+
+    parseButtons(getenv("SIM_BUTTONS"));
+    parseCommands(getenv("SIM_COMMANDS"));
+}
+
+}
+
+/**
+ * @brief Returns the virtual time in microseconds
+ */
+uint64_t now()
+{
+    return _now;
+}
+
+/**
+ * @brief Moves the virtual clock @a us microseconds forward, dispatching every
+ * event scheduled in the meantime.
+ */
+void advance(uint64_t us)
+{
+    uint64_t target = _now + us;
+
+    for(;;)
+    {
+        uint8_t next = EventCount;
+        for(uint8_t i = 0; i < EventCount; i++)
+            if(_events[i].when <= target && (next == EventCount || _events[i].when < _events[next].when))
+                next = i;
+
+        if(next == EventCount)
+            break;
+
+        if(_events[next].when > _now)
+            _now = _events[next].when;
+
+        Handler h = _events[next].handler;
+        _events[next].when = SIM_NEVER;
+        h();
+    }
+
+    if(target > _now)
+        _now = target;
+}
+
+/**
+ * @brief The CPU sleeps until the next interrupt: a scheduled event or the
+ * millis() tick, every millisecond.
+ */
+void idle()
+{
+    uint64_t wake = (_now / 1000 + 1) * 1000;
+    for(uint8_t i = 0; i < EventCount; i++)
+        if(_events[i].when > _now && _events[i].when < wake)
+            wake = _events[i].when;
+
+    _idleUs += wake - _now;
+    advance(wake - _now);
+}
+
+void schedule(uint8_t event, uint64_t when, Handler h)
+{
+    _events[event].when = when;
+    _events[event].handler = h;
+}
+
+void cancel(uint8_t event)
+{
+    _events[event].when = SIM_NEVER;
+}
+
+bool isScheduled(uint8_t event)
+{
+    return _events[event].when != SIM_NEVER;
+}
+
+void setInterruptsEnabled(bool enabled)
+{
+    _interruptsEnabled = enabled;
+
+    if(enabled && !_inInterrupt && _pendingCount)
+    {
+        Handler h = _pending[0];
+        memmove(_pending, _pending + 1, --_pendingCount * sizeof(Handler));
+        deliver(h);
+    }
+}
+
+bool interruptsEnabled()
+{
+    return _interruptsEnabled;
+}
+
+bool inInterrupt()
+{
+    return _inInterrupt;
+}
+
+/**
+ * @brief Raises an interrupt, it runs now or as soon as interrupts are enabled
+ */
+void raise(Handler h)
+{
+    deliver(h);
+}
+
+void attachInterrupt(uint8_t pin, Handler h, int mode)
+{
+    _interrupts[pin].handler = h;
+    _interrupts[pin].mode = mode;
+}
+
+void detachInterrupt(uint8_t pin)
+{
+    _interrupts[pin].handler = nullptr;
+}
+
+/**
+ * @brief Routes the rising edges of @a pin to a peripheral, through the event
+ * system. @a h runs right away, without being an interrupt.
+ */
+void routeEvent(uint8_t pin, Handler h)
+{
+    _interrupts[pin].event = h;
+}
+
+/**
+ * @brief When @a pin last went high
+ */
+uint64_t lastRise(uint8_t pin)
+{
+    return _rises[pin];
+}
+
+/**
+ * @brief Called when the firmware drives a pin
+ */
+void writePin(uint8_t pin, int level)
+{
+    int old = _pins[pin];
+    _pins[pin] = level ? HIGH : LOW;
+
+    if(pin == TRIAC_PIN && !old && level)
+        gateFired();
+}
+
+int readPin(uint8_t pin)
+{
+    return _pins[pin];
+}
+
+/**
+ * @brief Called when the outside world drives a pin, triggers the attached
+ * interrupt if any.
+ */
+void drivePin(uint8_t pin, int level)
+{
+    int old = _pins[pin];
+    _pins[pin] = level ? HIGH : LOW;
+
+    if(old == _pins[pin])
+        return;
+
+    const Interrupt& it = _interrupts[pin];
+    if(_pins[pin] == HIGH)
+    {
+        _rises[pin] = _now;
+        if(it.event)
+            it.event();
+    }
+
+    if(!it.handler)
+        return;
+
+    if(it.mode == CHANGE ||
+       (it.mode == RISING  && _pins[pin] == HIGH) ||
+       (it.mode == FALLING && _pins[pin] == LOW))
+        deliver(it.handler);
+}
+
+/**
+ * @brief A write transaction on the I2C bus. Costs 9 clock per byte plus
+ * start, address and stop.
+ */
+void i2cWrite(uint8_t addr, const uint8_t* data, size_t len, unsigned long clock)
+{
+    _i2cBytes += len;
+    advance((len + 2) * 9 * 1000000ull / clock);
+
+    if(addr != 0x3C || len == 0)
+        return;
+
+    if(data[0] & 0x40)
+        for(size_t i = 1; i < len; i++)
+            panelData(data[i]);
+    else
+        for(size_t i = 1; i < len; i++)
+            panelCommand(data[i]);
+}
+
+const uint8_t* panelRam()
+{
+    return _ram;
+}
+
+/**
+ * @brief A OneWire reset followed by @a bytes bytes. A bit slot is ~65us.
+ */
+void oneWireTransfer(unsigned int bytes)
+{
+    advance(960 + bytes * 8 * 65);
+}
+
+float sensorTemperature(uint8_t index)
+{
+    return _sensor + 0.25f * index + noise(0.03f);
+}
+
+uint8_t sensorCount()
+{
+    return _sensorCount;
+}
+
+bool sensorPresent(uint8_t index)
+{
+    if(index + 1 == _sensorCount && _now >= _sensorDrop)
+        return false;
+
+    return index < _sensorCount;
+}
+
+/**
+ * @brief An EEPROM byte write starts a 4ms erase/write cycle. Like avr-libc,
+ * it only waits for the previous one to finish, not for its own.
+ */
+void eepromWrite()
+{
+    if(_now < _eepromBusy)
+        advance(_eepromBusy - _now);
+
+    _eepromWrites++;
+    _eepromBusy = _now + 4000;
+}
+
+bool eepromBusy()
+{
+    return _now < _eepromBusy;
+}
+
+/**
+ * @brief Sends what the UART had time to send since the last call
+ */
+void serialDrain()
+{
+    while(_txCount && _now >= _txNext)
+    {
+        if(_serialOut)
+            fputc(_txFifo[_txHead], _serialOut);
+
+        _txHead = (_txHead + 1) % SIM_SERIAL_FIFO;
+        _txCount--;
+        _txNext += _txByteUs;
+        _serialBytes++;
+    }
+}
+
+/**
+ * @brief Opens the port at @a baud, 10 bits per byte. The host reads at most
+ * SIM_SERIAL_BPS bytes per second, what it receives goes to the SIM_SERIAL
+ * file.
+ */
+void serialBegin(unsigned long baud)
+{
+    uint64_t line = 10000000ull / baud;
+    float    host = envf("SIM_SERIAL_BPS", 0);
+    uint64_t read = host > 0 ? static_cast<uint64_t>(1e6f / host) : 0;
+
+    _txByteUs = line > read ? line : read;
+    _txCount  = 0;
+    _rxByteUs = line;
+
+    const char* path = getenv("SIM_SERIAL");
+    if(path && !_serialOut)
+        _serialOut = fopen(path, "wb");
+}
+
+/**
+ * @brief Free room in the transmit buffer of the core
+ */
+size_t serialRoom()
+{
+    serialDrain();
+    return SIM_SERIAL_FIFO - _txCount;
+}
+
+/**
+ * @brief Receives the bytes of SIM_COMMANDS sent since the last call, each
+ * line ending with a new line. What does not fit in the receive buffer of the
+ * core is lost.
+ */
+void serialReceive()
+{
+    if(!_rxByteUs)
+        return;
+
+    while(_nextCommand < _commandCount)
+    {
+        const Command& c = _commands[_nextCommand];
+        size_t len = strlen(c.text);
+
+        while(_commandSent <= len)
+        {
+            if(c.when + (_commandSent + 1) * _rxByteUs > _now)
+                return;
+
+            if(_rxCount < SIM_SERIAL_FIFO)
+            {
+                _rxFifo[(_rxHead + _rxCount) % SIM_SERIAL_FIFO] = _commandSent < len ? c.text[_commandSent] : '\n';
+                _rxCount++;
+            }
+            else
+                _rxLost++;
+
+            _commandSent++;
+        }
+
+        _nextCommand++;
+        _commandSent = 0;
+    }
+}
+
+/**
+ * @brief How many received bytes wait in the receive buffer of the core
+ */
+size_t serialAvailable()
+{
+    serialReceive();
+    return _rxCount;
+}
+
+/**
+ * @brief Takes the oldest received byte, -1 if there is none
+ */
+int serialRead()
+{
+    if(!serialAvailable())
+        return -1;
+
+    uint8_t c = _rxFifo[_rxHead];
+    _rxHead = (_rxHead + 1) % SIM_SERIAL_FIFO;
+    _rxCount--;
+    return c;
+}
+
+/**
+ * @brief Queues @a c for transmission. Like the core, waits for room when the
+ * buffer is full.
+ */
+void serialWrite(uint8_t c)
+{
+    if(!_txByteUs)
+        return;
+
+    serialDrain();
+    if(_txCount == SIM_SERIAL_FIFO)
+    {
+        advance(_txNext - _now);
+        serialDrain();
+    }
+
+    if(!_txCount)
+        _txNext = _now + _txByteUs;
+
+    _txFifo[(_txHead + _txCount) % SIM_SERIAL_FIFO] = c;
+    _txCount++;
+}
+
+float mainsHalfPeriod()
+{
+    return _halfPeriod;
+}
+
+float heaterPower()
+{
+    return _lastPower;
+}
+
+float enclosureTemperature()
+{
+    return _enclosure;
+}
+
+}
+
+#ifndef PIO_UNIT_TESTING
+
+/**
+ * Runs the firmware for argv[1] simulated seconds (600 by default) and prints
+ * a CSV line every SIM_REPORT seconds (10 by default).
+ * 
+ * The environment describes the board: SIM_MAINS_HZ, SIM_AMBIENT,
+ * SIM_HEATER_W, SIM_SENSORS, SIM_SENSOR_DROP (seconds after which the last
+ * sensor stops answering), SIM_GLITCHES (spurious zero crossing pulses per
+ * second), SIM_LOOP_COST (us spent per loop on top of what the firmware spends
+ * explicitly), SIM_BUTTONS (scripted presses), SIM_EEPROM (file holding the
+ * EEPROM content between runs), SIM_SERIAL (file receiving the serial output),
+ * SIM_SERIAL_BPS (how fast the host reads it) and SIM_COMMANDS (lines sent to
+ * the serial port).
+ */
+int main(int argc, char** argv)
+{
+    double seconds = argc > 1 ? atof(argv[1]) : 600;
+    uint64_t period = static_cast<uint64_t>(sim::envf("SIM_REPORT", 10) * 1e6);
+    uint64_t cost   = static_cast<uint64_t>(sim::envf("SIM_LOOP_COST", 30));
+
+    sim::begin();
+    EEPROM.load(getenv("SIM_EEPROM"));
+
+    setup();
+
+    uint64_t end = sim::now() + static_cast<uint64_t>(seconds * 1e6);
+    uint64_t nextReport = sim::now();
+    unsigned long loops = 0;
+    unsigned long totalLoops = 0;
+    unsigned long i2cBytes = 0;
+
+    printf("time_s,enclosure_c,sensor_c,heater_pct,relay,loop_us,i2c_bytes_s\n");
+
+    while(sim::now() < end)
+    {
+        loop();
+        sim::advance(cost);
+        loops++;
+
+        if(sim::now() >= nextReport)
+        {
+            double window = period / 1e6;
+
+            printf("%.1f,%.2f,%.2f,%.1f,%d,%.1f,%.0f\n",
+                   sim::now() / 1e6,
+                   sim::_enclosure,
+                   sim::_sensor,
+                   sim::_lastPower * 100,
+                   sim::readPin(RELAY_PIN),
+                   loops ? period / static_cast<double>(loops) : 0.0,
+                   (sim::_i2cBytes - i2cBytes) / window);
+
+            totalLoops += loops;
+            loops = 0;
+            i2cBytes = sim::_i2cBytes;
+            nextReport += period;
+        }
+    }
+
+    EEPROM.save(getenv("SIM_EEPROM"));
+
+    if(sim::_serialOut)
+        fclose(sim::_serialOut);
+
+    fprintf(stderr, "loops: %lu, i2c bytes: %lu, eeprom writes: %lu, serial bytes: %lu, idle: %.1f%%\n",
+            totalLoops + loops, sim::_i2cBytes, sim::_eepromWrites, sim::_serialBytes,
+            100.0 * sim::_idleUs / sim::now());
+
+    return 0;
+}
+
+#endif // PIO_UNIT_TESTING
@@ -0,0 +1,86 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief The sim namespace is the virtual board the native build runs on.
+ *
+ * It owns a virtual clock in microseconds, the level of every pin, the
+ * attached interrupts and a small model of what is wired to the Nano Every:
+ * the mains zero crossing detector, the triac and relay feeding a heater, the
+ * enclosure it warms up, the temperature sensor, the SSD1306 panel and the USB
+ * serial port.
+ *
+ * Time only moves forward when something spends it: the main loop, a delay(),
+ * a bus transfer, ... Scheduled events (mains edges, hardware timers) are
+ * dispatched in order while the clock advances, as interrupts would be.
+ */
+namespace sim
+{
+
+typedef void (*Handler)();
+
+/**
+ * @brief The hardware event sources. Each one has at most one pending
+ * occurrence.
+ */
+enum Event
+{
+    MainsEdge,
+    FiringTimer,
+    ButtonPress,
+    Glitch,
+    RtcOverflow,
+
+    EventCount
+};
+
+uint64_t now();
+void advance(uint64_t us);
+
+void schedule(uint8_t event, uint64_t when, Handler h);
+void cancel(uint8_t event);
+bool isScheduled(uint8_t event);
+
+void setInterruptsEnabled(bool enabled);
+bool interruptsEnabled();
+bool inInterrupt();
+void raise(Handler h);
+
+void attachInterrupt(uint8_t pin, Handler h, int mode);
+void detachInterrupt(uint8_t pin);
+void routeEvent(uint8_t pin, Handler h);
+uint64_t lastRise(uint8_t pin);
+
+void writePin(uint8_t pin, int level);
+int  readPin(uint8_t pin);
+void drivePin(uint8_t pin, int level);
+
+void i2cWrite(uint8_t addr, const uint8_t* data, size_t len, unsigned long clock);
+const uint8_t* panelRam();
+
+void oneWireTransfer(unsigned int bytes);
+float sensorTemperature(uint8_t index);
+uint8_t sensorCount();
+bool sensorPresent(uint8_t index);
+
+void idle();
+
+void eepromWrite();
+bool eepromBusy();
+
+void serialBegin(unsigned long baud);
+size_t serialRoom();
+void serialWrite(uint8_t c);
+size_t serialAvailable();
+int serialRead();
+
+float mainsHalfPeriod();
+float heaterPower();
+float enclosureTemperature();
+
+}
+
+#endif // SIM_H
@@ -0,0 +1,30 @@
+#ifndef UTIL_ATOMIC_H
+#define UTIL_ATOMIC_H
+
+#include "sim.h"
+
+/**
+ * @brief What avr-libc's ATOMIC_BLOCK(ATOMIC_RESTORESTATE) does, on the
+ * simulated board: interrupts are disabled for the block and left as they
+ * were on leaving it, enabled or not.
+ */
+struct AtomicRestore
+{
+    AtomicRestore() : enabled(sim::interruptsEnabled())
+    {
+        sim::setInterruptsEnabled(false);
+    }
+
+    ~AtomicRestore()
+    {
+        sim::setInterruptsEnabled(enabled);
+    }
+
+    bool enabled;
+    bool once = true;
+};
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_BLOCK(type) for(AtomicRestore _atomic; _atomic.once; _atomic.once = false)
+
+#endif // UTIL_ATOMIC_H
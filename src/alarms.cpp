@@ -0,0 +1,141 @@
+#include "alarms.h"
+
+#include <Arduino.h>
+
+Alarms _alarms;
+
+/**
+ * @brief Starts the countdown again, from now
+ */
+void Alarm::restart()
+{
+    _start = (uint32_t)millis();
+    _alarms.schedule(*this);
+}
+
+/**
+ * @brief Sets the number of milliseconds before the alarm fires, counted from
+ * the last restart(). An expired alarm is pending again if the time elapsed
+ * since is less than that.
+ */
+void Alarm::setDeadline(unsigned long z)
+{
+    deadline = z;
+
+    if(_pending || elapsedTime() < deadline)
+        _alarms.schedule(*this);
+}
+
+/**
+ * @brief Sets the time before the alarm fires
+ */
+void Alarm::setDeadline(unsigned int m,
+                        unsigned int s,
+                        unsigned long z)
+{
+    setDeadline(Timer::fromMinSec(m, s, z));
+}
+
+/**
+ * @brief Returns the remaining milliseconds before the alarm fires, 0 once it
+ * did
+ */
+unsigned long Alarm::remainingTime() const
+{
+    return _pending ? timeLeft() : 0;
+}
+
+/**
+ * @brief Breakdown the remaining milliseconds into @a m minutes and @a s seconds
+ */
+void Alarm::remainingTime(unsigned int& m,
+                          unsigned int& s) const
+{
+    Timer::toMinSec(remainingTime(), m, s);
+}
+
+/**
+ * @brief Returns whether the alarm fired, or was never started
+ */
+bool Alarm::hasExpired() const
+{
+    return !_pending;
+}
+
+/**
+ * @brief Returns the milliseconds elapsed since the last restart()
+ */
+uint32_t Alarm::elapsedTime() const
+{
+    return (uint32_t)millis() - _start;
+}
+
+/**
+ * @brief Returns the milliseconds left before the deadline, pending or not
+ */
+unsigned long Alarm::timeLeft() const
+{
+    uint32_t t = elapsedTime();
+    return t >= deadline ? 0 : deadline - t;
+}
+
+
+
+// =============================================================================
+
+
+
+/**
+ * @brief Inserts @a alarm where it belongs in the list, or moves it there if
+ * it is already pending.
+ */
+void Alarms::schedule(Alarm& alarm)
+{
+    cancel(alarm);
+
+    unsigned long left = alarm.timeLeft();
+
+    Alarm** link = &_head;
+    while(*link && (*link)->timeLeft() <= left)
+        link = &(*link)->_next;
+
+    alarm._next    = *link;
+    alarm._pending = true;
+    *link = &alarm;
+}
+
+/**
+ * @brief Removes @a alarm from the list, it does not fire
+ */
+void Alarms::cancel(Alarm& alarm)
+{
+    if(!alarm._pending)
+        return;
+
+    Alarm** link = &_head;
+    while(*link != &alarm)
+        link = &(*link)->_next;
+
+    *link = alarm._next;
+    alarm._next    = nullptr;
+    alarm._pending = false;
+}
+
+/**
+ * @brief Fires the alarms due. Only the next one is checked, the others are
+ * due after it.
+ */
+void Alarms::update()
+{
+    while(_head && !_head->timeLeft())
+    {
+        Alarm& alarm = *_head;
+
+        _head = alarm._next;
+        alarm._next    = nullptr;
+        alarm._pending = false;
+
+        // May restart it, it is out of the list already
+        alarm.fire();
+    }
+}
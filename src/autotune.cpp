@@ -0,0 +1,118 @@
+#include "autotune.h"
+#include <math.h>
+
+/**
+ * @brief Starts the experiment around @a setpoint, switching the output
+ * between @a low and @a high. @a input is the current temperature.
+ */
+void Autotune::start(float setpoint, float low, float high, float input)
+{
+    _setpoint = setpoint;
+    _low      = low;
+    _high     = high;
+
+    _rises        = 0;
+    _periodSum    = 0;
+    _amplitudeSum = 0;
+    _max = _min   = input;
+
+    cycles = 0;
+    status = Running;
+    timer.restart();
+
+    switchOutput(input < setpoint);
+}
+
+/**
+ * @brief Aborts the experiment, the gains are left untouched.
+ */
+void Autotune::stop()
+{
+    status = Off;
+}
+
+/**
+ * @brief Feeds a new temperature reading. Returns the status of the
+ * experiment, output is the power to apply.
+ */
+Autotune::Status Autotune::update(float input)
+{
+    if(status != Running)
+        return status;
+
+    if(timer.elapsedTime() > AUTOTUNE_TIMEOUT)
+    {
+        status = Failed;
+        return status;
+    }
+
+    if(input > _max) _max = input;
+    if(input < _min) _min = input;
+
+    if(_heating && input > _setpoint + AUTOTUNE_HYSTERESIS)
+    {
+        // A full oscillation lies between two rises, measure it
+        unsigned long now = timer.elapsedTime();
+        if(_rises >= 2)
+        {
+            _periodSum    += (now - _lastRise) / 1000.0f;
+            _amplitudeSum += (_max - _min) / 2;
+            cycles++;
+        }
+
+        _rises++;
+        _lastRise = now;
+        _max = _min = input;
+
+        switchOutput(false);
+
+        if(cycles >= AUTOTUNE_CYCLES)
+            status = computeGains() ? Done : Failed;
+    }
+    else if(!_heating && input < _setpoint - AUTOTUNE_HYSTERESIS)
+        switchOutput(true);
+
+    return status;
+}
+
+/**
+ * @brief Whether the experiment is running
+ */
+bool Autotune::isRunning() const
+{
+    return status == Running;
+}
+
+/**
+ * @brief Switches the relay output
+ */
+void Autotune::switchOutput(bool heat)
+{
+    _heating = heat;
+    output   = heat ? _high : _low;
+}
+
+/**
+ * @brief Computes kp, ki and kd from the measured oscillations
+ */
+bool Autotune::computeGains()
+{
+    float tu = _periodSum / cycles;
+    float a  = _amplitudeSum / cycles;
+
+    // The hysteresis makes the oscillation look bigger than it is
+    if(a <= AUTOTUNE_HYSTERESIS || tu <= 0)
+        return false;
+
+    a = sqrtf(a * a - AUTOTUNE_HYSTERESIS * AUTOTUNE_HYSTERESIS);
+
+    float d  = (_high - _low) / 2;
+    float ku = 4 * d / (M_PI * a);
+
+    // Tyreus-Luyben
+    kp = ku / 2.2f;
+    ki = kp / (2.2f * tu);
+    kd = kp * tu / 6.3f;
+
+    return true;
+}
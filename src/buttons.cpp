@@ -0,0 +1,196 @@
+#include "buttons.h"
+#include "controller.h"
+#include "pins.h"
+#include "scheduler.h"
+
+#include <Arduino.h>
+
+Buttons _buttons;
+
+#define BUTTON_MASK (BUTTON_QUEUE - 1)
+
+/**
+ * @brief Setups the pins and their interrupts, on both edges
+ */
+void Buttons::setup()
+{
+    pinMode(SW1_PIN, INPUT_PULLUP);
+    pinMode(SW2_PIN, INPUT_PULLUP);
+    pinMode(SW3_PIN, INPUT_PULLUP);
+
+    attachInterrupt(digitalPinToInterrupt(SW1_PIN), interruptLeft,   CHANGE);
+    attachInterrupt(digitalPinToInterrupt(SW2_PIN), interruptCenter, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(SW3_PIN), interruptRight,  CHANGE);
+}
+
+/**
+ * @brief Takes the next event into @a e. Returns false if there is none yet.
+ */
+bool Buttons::next(Event& e)
+{
+    settle();
+
+    while(_tail != _head)
+    {
+        const volatile Edge& edge = _edges[_tail];
+        unsigned long time   = edge.time;
+        uint8_t       button = edge.button;
+        bool          down   = edge.down;
+        _tail = (_tail + 1) & BUTTON_MASK;
+
+        e.button = button;
+
+        if(down)
+        {
+            _held       = button;
+            _long       = false;
+            _since      = time;
+            _nextRepeat = time + BUTTON_REPEAT_DELAY;
+            _interval   = BUTTON_REPEAT_START;
+
+            if(repeats(button))
+            {
+                e.kind = Press;
+                return true;
+            }
+        }
+        else if(button == _held)
+        {
+            _held = ButtonCount;
+
+            if(!repeats(button) && !_long)
+            {
+                e.kind = Press;
+                return true;
+            }
+        }
+    }
+
+    if(_held == ButtonCount)
+        return false;
+
+    unsigned long now = millis();
+    e.button = _held;
+
+    if(repeats(_held))
+    {
+        if((long)(now - _nextRepeat) < 0)
+            return false;
+
+        e.kind      = Repeat;
+        _nextRepeat = now + _interval;
+        _interval   = _interval * 3 / 4;
+        if(_interval < BUTTON_REPEAT_MIN)
+            _interval = BUTTON_REPEAT_MIN;
+        return true;
+    }
+
+    if(_long || now - _since < BUTTON_LONG)
+        return false;
+
+    e.kind = LongPress;
+    _long  = true;
+    return true;
+}
+
+/**
+ * @brief Whether a button is held or down, the events it makes then depend on
+ * time and its pin is read again once it settled
+ */
+bool Buttons::isHeld() const
+{
+    if(_held != ButtonCount)
+        return true;
+
+    for(uint8_t i = 0; i < ButtonCount; i++)
+        if(_down[i])
+            return true;
+
+    return false;
+}
+
+/**
+ * @brief Forgets the button held: it makes no more event, even when released
+ */
+void Buttons::forget()
+{
+    _held = ButtonCount;
+}
+
+/**
+ * @brief Whether @a button repeats when held, or has a long press
+ */
+bool Buttons::repeats(uint8_t button)
+{
+    return button != Center;
+}
+
+/**
+ * @brief Returns the pin of @a button
+ */
+uint8_t Buttons::pin(uint8_t button)
+{
+    static const uint8_t pins[ButtonCount] = {SW1_PIN, SW2_PIN, SW3_PIN};
+    return pins[button];
+}
+
+/**
+ * @brief Reads the pins again, in case the last edge of a button came during
+ * its debounce and was ignored.
+ */
+void Buttons::settle()
+{
+    noInterrupts();
+    for(uint8_t i = 0; i < ButtonCount; i++)
+        sample(i);
+    interrupts();
+}
+
+/**
+ * @brief Queues an edge of @a button if the level of its pin changed and the
+ * previous edge queued is BUTTON_DEBOUNCE old. Interrupts must be disabled.
+ *
+ * The first edge of a bounce is the one kept: the contacts go the way they
+ * settle to first. The pin may read the old level if it already bounced back,
+ * the edge is then left to the next one, or to settle().
+ */
+void Buttons::sample(uint8_t button)
+{
+    unsigned long now = millis();
+    bool down = digitalRead(pin(button)) == LOW;
+    if(down == _down[button] || now - _lastEdge[button] < BUTTON_DEBOUNCE)
+        return;
+
+    uint8_t next = (_head + 1) & BUTTON_MASK;
+    if(next == _tail)
+    {
+        overflows++;
+        return;
+    }
+
+    _down[button]     = down;
+    _lastEdge[button] = now;
+
+    volatile Edge& edge = _edges[_head];
+    edge.time   = now;
+    edge.button = button;
+    edge.down   = down;
+    _head = next;
+
+    _scheduler.signal(Controller::InputTask);
+}
+
+void Buttons::interruptLeft()
+{
+    _buttons.sample(Left);
+}
+
+void Buttons::interruptCenter()
+{
+    _buttons.sample(Center);
+}
+
+void Buttons::interruptRight()
+{
+    _buttons.sample(Right);
+}
@@ -0,0 +1,228 @@
+#include "console.h"
+#include "controller.h"
+#include "telemetry.h"
+#include "thermometer.h"
+#include "triac.h"
+#include "utils.h"
+
+#include <Arduino.h>
+
+Console _console;
+
+namespace
+{
+
+/**
+ * @brief A reply being printed, sent as a TELEMETRY_TEXT frame. What goes
+ * past TELEMETRY_PAYLOAD is cut.
+ */
+class Reply : public Print
+{
+public:
+    Reply()
+    {
+        _data[0] = TELEMETRY_TEXT;
+    }
+
+    size_t write(uint8_t c) override
+    {
+        if(_length >= TELEMETRY_PAYLOAD)
+            return 0;
+
+        _data[_length++] = c;
+        return 1;
+    }
+    using Print::write;
+
+    void send()
+    {
+        _telemetry.send(_data, _length);
+    }
+
+private:
+    uint8_t _data[TELEMETRY_PAYLOAD];
+    uint8_t _length = 1;
+};
+
+/**
+ * @brief Splits @a line on spaces, in place, into at most CONSOLE_ARGS words.
+ * Returns how many, 0 if there are too many.
+ */
+uint8_t split(char* line, char** args)
+{
+    uint8_t n = 0;
+
+    while(*line)
+    {
+        if(*line == ' ')
+        {
+            *line++ = 0;
+            continue;
+        }
+
+        if(n == CONSOLE_ARGS)
+            return 0;
+
+        args[n++] = line;
+        while(*line && *line != ' ')
+            line++;
+    }
+
+    return n;
+}
+
+bool is(const char* arg, const char* word)
+{
+    return strcmp_P(arg, word) == 0;
+}
+
+/**
+ * @brief Parses the sensor index of a bias command, or takes the first sensor
+ * if there is none.
+ */
+bool sensorArg(uint8_t n, char** args, uint8_t withIndex, uint8_t& i)
+{
+    long v = 0;
+    if(n == withIndex && !utils::parseFixed(args[2], 0, v))
+        return false;
+
+    i = v;
+    return v >= 0 && v < _thermo.sensorCount;
+}
+
+}
+
+/**
+ * @brief Called by the main loop. Takes the bytes received so far and runs the
+ * command once its line is complete.
+ */
+void Console::update()
+{
+    while(Serial.available() > 0)
+    {
+        char c = Serial.read();
+
+        if(c != '\n' && c != '\r')
+        {
+            if(_length < CONSOLE_LINE)
+                _line[_length++] = c;
+            else
+                _overflow = true;
+            continue;
+        }
+
+        // "\r\n" makes an empty line, ignored
+        if(_overflow)
+        {
+            Reply reply;
+            reply.print(F("err too long"));
+            reply.send();
+        }
+        else if(_length)
+        {
+            _line[_length] = 0;
+            execute();
+        }
+
+        _length   = 0;
+        _overflow = false;
+        return;
+    }
+}
+
+/**
+ * @brief Runs the command in _line and replies
+ */
+void Console::execute()
+{
+    char* args[CONSOLE_ARGS];
+    uint8_t n = split(_line, args);
+    uint8_t i = 0;
+    long    v = 0;
+
+    commands++;
+
+    Reply reply;
+
+    if(n == 1 && is(args[0], PSTR("status")))
+    {
+        reply.print(F("ok t="));
+        utils::printFixed(reply, utils::toHundredths(_thermo.temperature), 2);
+        reply.print(F(" sp="));
+        utils::printTenths(reply, _controller.ideal);
+        reply.print(F(" p="));
+        utils::printFixed(reply, _triac.power, 2);
+        reply.print(F(" left="));
+        reply.print(_controller.thermoTimer.remainingTime() / 1000);
+        reply.print(F(" st="));
+        reply.print(_controller.powerState);
+    }
+    else if(n == 2 && is(args[0], PSTR("get")) && is(args[1], PSTR("setpoint")))
+    {
+        reply.print(F("ok "));
+        utils::printTenths(reply, _controller.ideal);
+    }
+    else if(n == 3 && is(args[0], PSTR("set")) && is(args[1], PSTR("setpoint")))
+    {
+        if(utils::parseFixed(args[2], 1, v) && v >= 0 && v <= IDEAL_MAX)
+        {
+            _controller.setIdeal(v);
+            reply.print(F("ok "));
+            utils::printTenths(reply, _controller.ideal);
+        }
+        else
+            reply.print(F("err range"));
+    }
+    else if((n == 2 || n == 3) && is(args[0], PSTR("get")) && is(args[1], PSTR("bias")))
+    {
+        if(sensorArg(n, args, 3, i))
+        {
+            reply.print(F("ok "));
+            utils::printTenths(reply, _thermo.sensors[i].bias);
+        }
+        else
+            reply.print(F("err sensor"));
+    }
+    else if((n == 3 || n == 4) && is(args[0], PSTR("set")) && is(args[1], PSTR("bias")))
+    {
+        if(!sensorArg(n, args, 4, i))
+            reply.print(F("err sensor"));
+        else if(utils::parseFixed(args[n - 1], 1, v) && v >= -THERMO_MAX_BIAS && v <= THERMO_MAX_BIAS)
+        {
+            _controller.setBias(i, v);
+            reply.print(F("ok "));
+            utils::printTenths(reply, _thermo.sensors[i].bias);
+        }
+        else
+            reply.print(F("err range"));
+    }
+    else if(n == 2 && is(args[0], PSTR("get")) && is(args[1], PSTR("timer")))
+    {
+        unsigned int m, s;
+        Timer::toMinSec(_controller.thermoTimer.deadline, m, s);
+        reply.print(F("ok "));
+        reply.print(m);
+    }
+    else if(n == 3 && is(args[0], PSTR("set")) && is(args[1], PSTR("timer")))
+    {
+        // The same range as the buttons
+        if(utils::parseFixed(args[2], 0, v) && v >= 0 && v <= 99)
+        {
+            _controller.setTimer(v);
+            _controller.resetTimer();
+            reply.print(F("ok "));
+            reply.print(v);
+        }
+        else
+            reply.print(F("err range"));
+    }
+    else if(n == 2 && is(args[0], PSTR("reset")) && is(args[1], PSTR("timer")))
+    {
+        _controller.resetTimer();
+        reply.print(F("ok"));
+    }
+    else
+        reply.print(F("err unknown"));
+
+    reply.send();
+}
@@ -1,9 +1,33 @@
 #include "controller.h"
+#include "console.h"
+#include "hal.h"
+#include "history.h"
+#include "power.h"
+#include "profiler.h"
+#include "scheduler.h"
+#include "telemetry.h"
 #include "thermometer.h"
 #include "triac.h"
 
 Controller _controller;
 
+/**
+ * @brief The main loop, see Scheduler. Regulation comes first, the screen
+ * last but for the EEPROM, which is never in a hurry. The buttons are read
+ * when their interrupt signals an edge, and polled while one is held. The
+ * screen is not drawn while off.
+ */
+Task Controller::tasks[TaskCount] = {
+    // name       run                                              ms  budget us
+    {"Power",    [](){_controller.updatePower();},                 1,  200},
+    {"Sensor",   [](){_controller.pollSensors();},                 10, 25000},
+    {"Regulate", [](){_controller.updateTemperature();},           10, 2000},
+    {"Input",    [](){_controller.processButtonPressed();},        0,  2000},
+    {"Serial",   [](){_console.update(); _telemetry.update();},    5,  1000},
+    {"Render",   [](){_controller.updateUI();},                    50, 25000},
+    {"Settings", [](){_settings.update();},                        5,  500},
+};
+
 /**
  * @brief Setups everything, sensor, screen, timers, etc...
  */
@@ -13,16 +37,41 @@ void Controller::setup()
     
     // Setup UI
     _ui.setup();
+    _buttons.setup();
     _ui.drawLoadingScreen();
 
+    // Load settings
+    _settings.load();
+    const Config& config = _settings.config;
+
+    ideal = config.ideal >= 0 && config.ideal <= IDEAL_MAX ? config.ideal : 0;
+
     // Setup Thermo
-    EEPROM.get(BIAS_ADDR, _thermo.bias);
+    // Out of range values fall back to defaults in the setup
+    for(uint8_t i = 0; i < THERMO_MAX_SENSORS; i++)
+    {
+        _thermo.sensors[i].bias   = config.bias[i];
+        _thermo.sensors[i].weight = config.weight[i];
+    }
+
+    _thermo.aggregate   = config.aggregate;
+    _thermo.filter.mode = config.filter;
+    _thermo.resolution  = config.resolution;
+    _thermo.setTarget(utils::fromTenths(ideal));
     _thermo.setup();
 
-    EEPROM.get(IDEAL_ADDR, ideal);
+    // Setup regulation
+    pid.setGains(config.kp, config.ki, config.kd);
+    pid.setup();
+
+    // Keep the fallback, not what was unusable
+    _settings.config.kp = pid.kp;
+    _settings.config.ki = pid.ki;
+    _settings.config.kd = pid.kd;
 
     // Setup Triac
     _triac.setup();
+    _triac.setBurst(config.burst);
 
     // Setup Relay
     pinMode(RELAY_PIN, OUTPUT);
@@ -32,63 +81,175 @@ void Controller::setup()
     screenTimer.setDeadline(1, 0);
     screenTimer.restart();
 
-    unsigned long z;
-    EEPROM.get(TIMER_ADDR, z);
-    setTimer(0, 0, z);
+    setTimer(0, 0, config.timer);
     resetTimer();
 
+    _history.setup();
+    _telemetry.setup();
+
     turnOn();
+
+    if(REGULATION_TICK)
+    {
+        lastTick = micros();
+        hal::setupTick(REGULATION_TICK, tick);
+    }
+
+    _scheduler.setup(tasks, TaskCount);
+    _ui.loopTimer.restart();
 }
 
 /**
- * @brief called on every loop. Update Ui and temperature state
+ * @brief called on every loop. Runs the next task due, or fires the alarms due
+ * and sleeps until one may be. The alarms are seconds long, they can wait for
+ * the tasks.
  */
 void Controller::update()
 {
-    updateTemperature();
-    processButtonPressed();
-    updateUI();
+    _ui.loopTime = _ui.loopTimer.elapsedTime();
+    _ui.loopTimer.restart();
+    _profiler.record(Profiler::Loop, _ui.loopTime);
+    _telemetry.recordLoop(_ui.loopTime);
+
+    if(!_scheduler.runNext())
+    {
+        _alarms.update();
+        _scheduler.idle();
+
+        // The time asleep is not the loop's
+        _ui.loopTimer.restart();
+    }
 }
 
 /**
- * @brief Reads the temperature and adapt the heat power consequently.
+ * @brief Advances the power sequence started by turnOn() or turnOff().
  * 
- * If the timer expired, turns the heat off.
+ * Each step waits for the hardware without blocking, so the buttons, the
+ * screen and the sensor keep working meanwhile.
  */
-void Controller::updateTemperature()
+void Controller::updatePower()
 {
-    _thermo.update();
+    _triac.update();
 
-    if(thermoTimer.hasExpired())
+    switch(powerState)
     {
-        if(isTurnedOn)
-            turnOff();
+    case PowerSyncing:
+        if(_triac.updateSync())
+        {
+            // Resume regulating from the power we had when turned off
+            pid.setLimits(0, POWER_MAX);
+            pid.reset(pid.output);
+            _triac.setPower(pid.output);
+
+            _triac.turnOn();
+
+            powerTimer.setDeadline(1000);
+            powerTimer.restart();
+            powerState = PowerArming;
+        }
+        break;
+
+    case PowerArming:
+        if(powerTimer.hasExpired())
+        {
+            // Switch the relay on
+            digitalWrite(RELAY_PIN, HIGH);
+            digitalWrite(LED_PIN, HIGH);
+
+            powerTimer.setDeadline(500);
+            powerTimer.restart();
+            powerState = PowerSettling;
+        }
+        break;
+
+    case PowerSettling:
+        if(powerTimer.hasExpired())
+            powerState = PowerOn;
+        break;
+
+    case PowerStopping:
+        if(powerTimer.hasExpired())
+        {
+            digitalWrite(LED_PIN, LOW);
+            powerState = PowerOff;
+        }
+        break;
+
+    default:
+        break;
     }
-    else
+}
+
+/**
+ * @brief Reads the sensors once their conversion is done, see Thermometer
+ */
+void Controller::pollSensors()
+{
+    ScopedProbe probe(Profiler::Temperature);
+
+    _thermo.update();
+}
+
+/**
+ * @brief Adapts the heat power to the temperature.
+ * 
+ * Turns the heat back on when the timer runs again. The power is only adjusted
+ * when a new temperature has been read and the main line is fully on.
+ */
+void Controller::updateTemperature()
+{
+    bool fresh = _thermo.hasNewReading();
+    if(fresh)
+        _history.add(_thermo.temperature, ideal, powerState == PowerOn ? _triac.power : 0);
+
+    // Once it expired, thermoExpired() turned the main line off
+    if(!thermoTimer.hasExpired())
     {
         if(!isTurnedOn)
             turnOn();
 
-             if (shouldWarmUp())   warmUp();
-        else if (shouldCoolDown()) coolDown();
+        if(fresh && powerState == PowerOn)
+        {
+            if(autotune.isRunning())
+                tune();
+            else if(!REGULATION_TICK)
+                regulate();
+        }
     }
+
+    if(REGULATION_TICK)
+        handOff(isTurnedOn && powerState == PowerOn && !autotune.isRunning());
 }
 
 /**
  * @brief Called when a button has been pressed. Set the current controller state
  * depending on the button pressed.
+ *
+ * Every event queued is processed, none is lost while the loop was busy. A
+ * long press on center goes back to idle from anywhere but autotuning.
  */
 void Controller::processButtonPressed()
 {
-    if(_ui.hasButtonBeenPressed())
+    ScopedProbe probe(Profiler::Buttons);
+
+    while(_buttons.next(event))
     {
         bool expired = screenTimer.hasExpired();
 
         screenTimer.restart();
         if(expired)
         {
-            _ui.resetButtons();
-            return;
+            // Only wakes the screen up, even if held
+            _scheduler.resume(RenderTask);
+            _buttons.forget();
+            continue;
+        }
+
+        // Autotuning only ever leaves through a press, which stops it
+        if(event.kind == Buttons::LongPress && state != Autotuning)
+        {
+            state = Idle;
+            continue;
         }
 
         switch(state)
@@ -102,7 +263,14 @@ void Controller::processButtonPressed()
             break;
         
         case MenuSetTempBias:
-            processMenu(SetTempBias, [=](){biasTmp = _thermo.bias;});
+            // The way the sensors are combined only matters with several
+            processMenu(_thermo.sensorCount > 1 ? SetAggregate : SetTempBias,
+                        [=]()
+                        {
+                            aggregateTmp = _thermo.aggregate;
+                            sensorIndex = 0;
+                            biasTmp = _thermo.sensors[0].bias;
+                        });
             break;
 
         case MenuSetTime:
@@ -118,12 +286,33 @@ void Controller::processButtonPressed()
             processMenu(Idle, [=](){resetTimer();});
             break;
 
+        case MenuSetMode:
+            processMenu(SetMode, [=](){modeTmp = _triac.burstCycles;});
+            break;
+
+        case MenuSetSensor:
+            processMenu(SetSensor,
+                        [=]()
+                        {
+                            sensorTmp = _thermo.resolution;
+                            filterTmp = _thermo.filter.mode;
+                        });
+            break;
+
+        case MenuAutotune:
+            processMenu(Autotuning, [=](){startAutotune();});
+            break;
+
+        case MenuHistory:
+            processMenu(ShowHistory);
+            break;
+
         case MenuShowLoading:
             processMenu(LoadingScreen);
             break;
 
         case MenuDebug:
-            processMenu(Debug);
+            processMenu(Debug, [=](){debugPage = 0;});
             break;
 
         case MenuReturn:
@@ -131,8 +320,8 @@ void Controller::processButtonPressed()
             break;
 
         case SetTemp:
-            processActions([=](){idealTmp--; if(idealTmp < 0)  idealTmp = 99;},
-                           [=](){idealTmp++; if(idealTmp > 99) idealTmp = 0;},
+            processActions([=](){idealTmp-=5; if(idealTmp < 0)         idealTmp = IDEAL_MAX;},
+                           [=](){idealTmp+=5; if(idealTmp > IDEAL_MAX) idealTmp = 0;},
                            [=]()
                            {
                                setIdeal(idealTmp);
@@ -140,14 +329,42 @@ void Controller::processButtonPressed()
                            });
             break;
 
+        case SetAggregate:
+            processActions([=](){aggregateTmp = (aggregateTmp + Thermometer::AggregateCount - 1) % Thermometer::AggregateCount;},
+                           [=](){aggregateTmp = (aggregateTmp + 1) % Thermometer::AggregateCount;},
+                           [=]()
+                           {
+                               _thermo.setAggregate(aggregateTmp);
+                               _settings.set(_settings.config.aggregate, _thermo.aggregate);
+                               calibrateSensor(0);
+                           });
+            break;
+
         case SetTempBias:
-            processActions([=](){biasTmp-=0.5; if(biasTmp < -5) biasTmp =  5;},
-                           [=](){biasTmp+=0.5; if(biasTmp >  5) biasTmp = -5;},
+            processActions([=](){biasTmp--; if(biasTmp < -THERMO_MAX_BIAS) biasTmp =  THERMO_MAX_BIAS;},
+                           [=](){biasTmp++; if(biasTmp >  THERMO_MAX_BIAS) biasTmp = -THERMO_MAX_BIAS;},
                            [=]()
                            {
-                               _thermo.bias = biasTmp;
-                               EEPROM.update(BIAS_ADDR, _thermo.bias);
-                               state = Idle;
+                               setBias(sensorIndex, biasTmp);
+
+                               if(_thermo.sensorCount > 1 && _thermo.aggregate == Thermometer::Weighted)
+                               {
+                                   weightTmp = _thermo.sensors[sensorIndex].weight;
+                                   state = SetSensorWeight;
+                               }
+                               else
+                                   calibrateSensor(sensorIndex + 1);
+                           });
+            break;
+
+        case SetSensorWeight:
+            processActions([=](){weightTmp--; if(weightTmp < 0)                 weightTmp = THERMO_MAX_WEIGHT;},
+                           [=](){weightTmp++; if(weightTmp > THERMO_MAX_WEIGHT) weightTmp = 0;},
+                           [=]()
+                           {
+                               _thermo.sensors[sensorIndex].weight = weightTmp;
+                               _settings.set(_settings.config.weight[sensorIndex], weightTmp);
+                               calibrateSensor(sensorIndex + 1);
                            });
             break;
 
@@ -162,64 +379,171 @@ void Controller::processButtonPressed()
                            });
             break;
 
-        default:
-            state = Idle;
-            break;
-        }
-
-        _ui.resetButtons();
-    }
-}
-
-/**
- * @brief Updates what is drawn on screen depending on the controller state.
- */
-void Controller::updateUI()
-{
-    if (screenTimer.hasExpired())
-        _ui.turnOff();
-    else
-    {
-        _ui.turnOn();
-
-        switch(state)
-        {
-        default:
-        case Idle:
-            _ui.drawIdleScreen();
+        case SetMode:
+            processActions([=](){modeTmp = nextMode(modeTmp, -1);},
+                           [=](){modeTmp = nextMode(modeTmp,  1);},
+                           [=]()
+                           {
+                               _triac.setBurst(modeTmp);
+                               _settings.set(_settings.config.burst, modeTmp);
+                               state = Idle;
+                           });
             break;
 
-        case MenuSetTemp:
-        case MenuSetTempBias:
-        case MenuSetTime:
-        case MenuResetTime:
-        case MenuShowLoading:
-        case MenuDebug:
-        case MenuReturn:
-            _ui.drawMenuScreen();
+        case SetSensor:
+            processActions([=](){sensorTmp = nextResolution(sensorTmp, -1);},
+                           [=](){sensorTmp = nextResolution(sensorTmp,  1);},
+                           [=]()
+                           {
+                               _thermo.setResolution(sensorTmp);
+                               _settings.set(_settings.config.resolution, _thermo.resolution);
+                               state = SetFilter;
+                           });
             break;
 
-        case SetTemp:
-            _ui.drawSetTempScreen();
+        case SetFilter:
+            processActions([=](){filterTmp = (filterTmp + Filter::ModeCount - 1) % Filter::ModeCount;},
+                           [=](){filterTmp = (filterTmp + 1) % Filter::ModeCount;},
+                           [=]()
+                           {
+                               if(filterTmp != _thermo.filter.mode)
+                               {
+                                   _thermo.setFilter(filterTmp);
+                                   _settings.set(_settings.config.filter, _thermo.filter.mode);
+                               }
+                               state = Idle;
+                           });
             break;
 
-        case SetTempBias:
-            _ui.drawSetTempBiasScreen();
+        case Debug:
+            // On the firing page, the center button cycles through the gate
+            // and start modes.
+            processActions([=](){debugPage = (debugPage + DebugPageCount - 1) % DebugPageCount;},
+                           [=](){debugPage = (debugPage + 1) % DebugPageCount;},
+                           [=]()
+                           {
+                               if(debugPage == DebugFiring)
+                               {
+                                   if(_triac.edgeStart)
+                                       _triac.setHardwareGate(!_triac.hardwareGate);
+                                   _triac.setEdgeStart(!_triac.edgeStart);
+                               }
+                               else
+                                   state = Idle;
+                           });
             break;
 
-        case SetTime:
-            _ui.drawSetTimeScreen();
+        case ShowHistory:
+            // Left and right change how long each column lasts
+            processActions([=](){_history.setPeriod(History::nextPeriod(_history.period, -1));},
+                           [=](){_history.setPeriod(History::nextPeriod(_history.period,  1));},
+                           [=](){state = Idle;});
             break;
 
-        case LoadingScreen:
-            _ui.drawLoadingScreen();
+        case Autotuning:
+            if(autotune.isRunning())
+                processActions([](){},
+                               [](){},
+                               [=]()
+                               {
+                                   stopAutotune();
+                                   state = Idle;
+                               });
+            else
+                state = Idle;
             break;
 
-        case Debug:
-            _ui.drawDebugScreen();
+        default:
+            state = Idle;
             break;
         }
     }
+
+    // A held button makes events as time goes, not only on interrupts
+    _scheduler.setPeriod(InputTask, _buttons.isHeld() ? BUTTON_POLL : 0);
+}
+
+/**
+ * @brief Updates what is drawn on screen depending on the controller state.
+ * 
+ * The screen is only redrawn when what it shows changed, see Ui::render()
+ */
+void Controller::updateUI()
+{
+    ScopedProbe probe(Profiler::Render);
+
+    // Suspended by screenExpired() while the screen is off
+    _ui.turnOn();
+
+    switch(state)
+    {
+    default:
+    case Idle:
+        _ui.render(Ui::idleScreen);
+        break;
+
+    case MenuSetTemp:
+    case MenuSetTempBias:
+    case MenuSetTime:
+    case MenuResetTime:
+    case MenuSetMode:
+    case MenuSetSensor:
+    case MenuAutotune:
+    case MenuHistory:
+    case MenuShowLoading:
+    case MenuDebug:
+    case MenuReturn:
+        _ui.render(Ui::menuScreen);
+        break;
+
+    case SetTemp:
+        _ui.render(Ui::setTempScreen);
+        break;
+
+    case SetAggregate:
+        _ui.render(Ui::setAggregateScreen);
+        break;
+
+    case SetTempBias:
+        _ui.render(Ui::setTempBiasScreen);
+        break;
+
+    case SetSensorWeight:
+        _ui.render(Ui::setWeightScreen);
+        break;
+
+    case SetTime:
+        _ui.render(Ui::setTimeScreen);
+        break;
+
+    case SetMode:
+        _ui.render(Ui::setModeScreen);
+        break;
+
+    case SetSensor:
+        _ui.render(Ui::setSensorScreen);
+        break;
+
+    case SetFilter:
+        _ui.render(Ui::setFilterScreen);
+        break;
+
+    case Autotuning:
+        _ui.render(Ui::autotuneScreen);
+        break;
+
+    case ShowHistory:
+        _ui.render(Ui::historyScreen);
+        break;
+
+    case LoadingScreen:
+        _ui.render(Ui::loadingScreen);
+        break;
+
+    case Debug:
+        _ui.render(Ui::debugScreen);
+        break;
+    }
 }
 
 /**
@@ -239,53 +563,171 @@ void Controller::processMenu(int accept)
 }
 
 /**
- * @brief Increase the heat power
+ * @brief Computes the heat power from the last temperature reading.
+ * 
+ * The PID commands the power itself (0..POWER_MAX), the triac turns it into
+ * the right delay, so the loop gain is the same at any power.
+ * It uses the actual time between 2 readings as sample period.
+ */
+void Controller::regulate()
+{
+    float power = pid.compute(ideal / 10.0f,
+                              utils::toCelsius(_thermo.temperature),
+                              _thermo.samplePeriod / 1000.0f);
+    _triac.setPower(power);
+}
+
+/**
+ * @brief Hands the last temperature and the ideal one to the regulation tick,
+ * and whether it drives the power at all. The main loop leaves the Pid and
+ * the power alone while it does. Interrupts are held so the tick never sees
+ * half of it.
  */
-void Controller::warmUp()
+void Controller::handOff(bool active)
 {
-    _triac.decDelay(10);
+    noInterrupts();
+    tickTemperature = _thermo.temperature;
+    tickIdeal       = ideal;
+    ticking         = active;
+    interrupts();
 }
 
 /**
- * @brief Decrease the heat power
+ * @brief The regulation tick, from the RTC interrupt every REGULATION_TICK
+ * milliseconds. Computes the power from what handOff() gave, with the period
+ * actually measured, and sets it right away.
+ * 
+ * The jitter is how much each period differs from the previous one, the RTC
+ * oscillator being too inaccurate to compare them to REGULATION_TICK.
+ *
+ * The other interrupts wait for it to return, the TickIsr probe tells how
+ * long. Nothing it calls enables them again: the Triac only ever restores
+ * the interrupt state it found.
  */
-void Controller::coolDown()
+void Controller::tick()
 {
-    _triac.incDelay(10);
+    ScopedProbe probe(Profiler::TickIsr);
+    Controller& c = _controller;
+
+    unsigned long now    = micros();
+    unsigned long period = now - c.lastTick;
+    c.lastTick = now;
+
+    if(c.lastTickPeriod)
+        _profiler.record(Profiler::TickJitter, period > c.lastTickPeriod ?
+                                               period - c.lastTickPeriod :
+                                               c.lastTickPeriod - period);
+    c.lastTickPeriod = period;
+
+    if(!c.ticking)
+        return;
+
+    float power = c.pid.compute(c.tickIdeal / 10.0f,
+                                utils::toCelsius(c.tickTemperature),
+                                period / 1000000.0f);
+    _triac.setPower(power);
 }
 
 /**
- * @brief Cut the main line off
+ * @brief Starts identifying the system around the ideal temperature, the
+ * relay switches between no power and full power.
+ */
+void Controller::startAutotune()
+{
+    handOff(false);
+    autotune.start(ideal / 10.0f, 0, POWER_MAX, utils::toCelsius(_thermo.temperature));
+}
+
+/**
+ * @brief Aborts the autotune and gives the power back to the PID
+ */
+void Controller::stopAutotune()
+{
+    if(autotune.isRunning())
+    {
+        autotune.stop();
+        pid.reset(pid.output);
+    }
+}
+
+/**
+ * @brief Drives the power for the autotune from the last temperature reading.
+ * 
+ * Once it is done, the new gains are saved and the PID takes over again.
+ */
+void Controller::tune()
+{
+    switch(autotune.update(utils::toCelsius(_thermo.temperature)))
+    {
+    case Autotune::Running:
+        _triac.setPower(autotune.output);
+        break;
+
+    case Autotune::Done:
+        setGains(autotune.kp, autotune.ki, autotune.kd);
+        pid.reset(pid.output);
+        break;
+
+    default:
+        pid.reset(pid.output);
+        break;
+    }
+}
+
+/**
+ * @brief Cut the main line off. The led goes off once the relay is open, see
+ * updatePower().
  */
 void Controller::turnOff()
 {
+    handOff(false);
+    stopAutotune();
+
+    _triac.stopSync();
     _triac.turnOff();
 
     // Switch the relay off
     digitalWrite(RELAY_PIN, LOW);
-    delay(500);
-    digitalWrite(LED_PIN, LOW);
+
+    powerTimer.setDeadline(500);
+    powerTimer.restart();
+    powerState = PowerStopping;
 
     isTurnedOn = false;
 }
 
 /**
- * @brief Turn on the main line
+ * @brief Turn on the main line. It starts measuring the zero crossing
+ * detector, the rest of the sequence happens in updatePower().
  */
 void Controller::turnOn()
 {
-    _triac.detectSync();
-    _triac.turnOn();
-
-    delay(1000);
-    // Switch the relay on
-    digitalWrite(RELAY_PIN, HIGH);
-    digitalWrite(LED_PIN, HIGH);
-    delay(500);
+    _triac.startSync();
+    powerState = PowerSyncing;
 
     isTurnedOn = true;
 }
 
+/**
+ * @brief Called when the screen timer expires. Turns the screen off, it is not
+ * drawn until a button is pressed.
+ */
+void Controller::screenExpired()
+{
+    _ui.turnOff();
+    _scheduler.suspend(RenderTask);
+}
+
+/**
+ * @brief Called when the main timer expires. Turns the main line off, until
+ * the timer is reset or set longer.
+ */
+void Controller::thermoExpired()
+{
+    if(_controller.isTurnedOn)
+        _controller.turnOff();
+}
+
 /**
  * @brief Set and save the ideal temperature
  */
@@ -294,16 +736,86 @@ void Controller::setIdeal(int i)
     if(ideal != i)
     {
         ideal = i;
-        EEPROM.put(IDEAL_ADDR, ideal);
+        _settings.set(_settings.config.ideal, ideal);
+        _thermo.setTarget(utils::fromTenths(ideal));
     }
 }
 
+/**
+ * @brief Set and save the bias of the sensor @a i, in tenths of C
+ */
+void Controller::setBias(uint8_t i, int bias)
+{
+    _thermo.sensors[i].bias = bias;
+    _settings.set(_settings.config.bias[i], bias);
+}
+
+/**
+ * @brief Moves the calibration on to the sensor @a i, or back to Idle after
+ * the last one.
+ */
+void Controller::calibrateSensor(uint8_t i)
+{
+    if(i < _thermo.sensorCount)
+    {
+        sensorIndex = i;
+        biasTmp = _thermo.sensors[i].bias;
+        state = SetTempBias;
+    }
+    else
+        state = Idle;
+}
+
+/**
+ * @brief Returns the power mode @a step places after @a mode in the list the
+ * user picks from: phase angle (0) then burst fire with a few resolutions.
+ */
+int Controller::nextMode(int mode, int step)
+{
+    static const uint8_t modes[] = {0, 10, 25, 50, 100};
+    const int count = sizeof(modes)/sizeof(modes[0]);
+
+    int i = 0;
+    while(i < count && modes[i] != mode)
+        i++;
+
+    return modes[(i + step + count) % count];
+}
+
+/**
+ * @brief Returns the sensor resolution @a step places after @a res in the list
+ * the user picks from: 9 to 12 bits then adaptive.
+ */
+int Controller::nextResolution(int res, int step)
+{
+    static const uint8_t resolutions[] = {9, 10, 11, 12, THERMO_ADAPTIVE};
+    const int count = sizeof(resolutions)/sizeof(resolutions[0]);
+
+    int i = 0;
+    while(i < count && resolutions[i] != res)
+        i++;
+
+    return resolutions[(i + step + count) % count];
+}
+
+/**
+ * @brief Set and save the regulation gains
+ */
+void Controller::setGains(float kp, float ki, float kd)
+{
+    pid.setGains(kp, ki, kd);
+
+    _settings.set(_settings.config.kp, pid.kp);
+    _settings.set(_settings.config.ki, pid.ki);
+    _settings.set(_settings.config.kd, pid.kd);
+}
+
 /**
  * @brief Returns true if it should be warmer
  */
 bool Controller::shouldWarmUp()   const
 {
-    return _thermo.temperature < ideal;
+    return _thermo.temperature < utils::fromTenths(ideal);
 }
 
 /**
@@ -311,7 +823,7 @@ bool Controller::shouldWarmUp()   const
  */
 bool Controller::shouldCoolDown() const
 {
-    return _thermo.temperature > ideal;
+    return _thermo.temperature > utils::fromTenths(ideal);
 }
 
 /**
@@ -323,7 +835,7 @@ void Controller::setTimer(unsigned int m, unsigned int s, unsigned long z)
     if(thermoTimer.deadline != z2)
     {
         thermoTimer.setDeadline(z2);
-        EEPROM.put(TIMER_ADDR, z2);
+        _settings.set(_settings.config.timer, z2);
     }
 }
 
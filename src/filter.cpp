@@ -0,0 +1,171 @@
+#include "filter.h"
+#include <Arduino.h>
+
+/**
+ * @brief Sets the filter, see Mode. Anything else falls back to Ema.
+ */
+void Filter::setMode(uint8_t m)
+{
+    mode = m < ModeCount ? m : (uint8_t)Ema;
+    reset();
+}
+
+/**
+ * @brief Returns the display name of @a mode
+ */
+const char* Filter::name(uint8_t mode)
+{
+    switch(mode)
+    {
+    case None:   return "None";
+    case Ema:    return "Ema";
+    case Median: return "Median";
+    case Kalman: return "Kalman";
+    default:     return "?";
+    }
+}
+
+/**
+ * @brief Forgets the past readings, the next one goes through as is.
+ */
+void Filter::reset()
+{
+    _primed    = false;
+    _lastCount = 0;
+    _lastIndex = 0;
+}
+
+/**
+ * @brief Filters the reading @a x, taken @a dt milliseconds after the previous
+ * one at a resolution of @a bits.
+ */
+int16_t Filter::update(int16_t x, unsigned long dt, uint8_t bits)
+{
+    if(!_primed)
+    {
+        _ema    = (int32_t)x << 4;
+        _x      = x;
+        _p      = 0;
+        _primed = true;
+    }
+
+    switch(mode)
+    {
+    case Ema:
+    {
+        if(dt > 60000)
+            dt = 60000;
+
+        int32_t a = ((uint32_t)dt << 8) / (FILTER_EMA_TAU + dt);
+        _ema += ((((int32_t)x << 4) - _ema) * a) >> 8;
+        return (_ema + 8) >> 4;
+    }
+
+    case Median:
+        return median(x);
+
+    case Kalman:
+    {
+        // The quantization of a resolution is uniform noise of step^2 / 12
+        float step = 8 << (12 - bits);
+        float r = step * step / 12 + FILTER_KALMAN_R0;
+
+        _p += FILTER_KALMAN_Q * dt / 1000.0f;
+
+        float k = _p / (_p + r);
+        _x += k * (x - _x);
+        _p *= 1 - k;
+
+        return lroundf(_x);
+    }
+
+    default:
+    case None:
+        return x;
+    }
+}
+
+/**
+ * @brief Adds @a x to the last readings and returns their median.
+ */
+int16_t Filter::median(int16_t x)
+{
+    _last[_lastIndex] = x;
+    _lastIndex = (_lastIndex + 1) % FILTER_MEDIAN_N;
+    if(_lastCount < FILTER_MEDIAN_N)
+        _lastCount++;
+
+    // Insertion sort, on a handful of values
+    int16_t sorted[FILTER_MEDIAN_N];
+    for(uint8_t i = 0; i < _lastCount; i++)
+    {
+        int16_t v = _last[i];
+        uint8_t j = i;
+        for(; j > 0 && sorted[j - 1] > v; j--)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = v;
+    }
+
+    return sorted[(_lastCount - 1) / 2];
+}
+
+// =============================================================================
+
+/**
+ * @brief Forgets the past samples.
+ */
+void Trend::reset()
+{
+    _count = 0;
+    _head  = 0;
+    _s0    = 0;
+    _s1    = 0;
+    slope  = 0;
+}
+
+/**
+ * @brief Adds the temperature @a x read at @a now milliseconds, if the last
+ * sample is old enough, and updates the slope.
+ */
+void Trend::update(int16_t x, unsigned long now)
+{
+    if(_count)
+    {
+        if(now - _last < TREND_SLOT)
+            return;
+
+        _period = now - _last;
+    }
+
+    _last = now;
+
+    if(_count < TREND_N)
+    {
+        _s1 += (int32_t)_count * x;
+        _s0 += x;
+        _count++;
+    }
+    else
+    {
+        // Every sample moves down one index and the oldest one leaves
+        int16_t old = _ring[_head];
+        _s1 += (int32_t)(TREND_N - 1) * x - (_s0 - old);
+        _s0 += x - old;
+    }
+
+    _ring[_head] = x;
+    _head = (_head + 1) % TREND_N;
+
+    if(_count < 3)
+    {
+        slope = 0;
+        return;
+    }
+
+    int32_t n   = _count;
+    int32_t num = n * _s1 - n * (n - 1) / 2 * _s0;
+    int32_t den = n * n * (n * n - 1) / 12;
+
+    float s = num * 60000.0f / (den * (float)_period);
+    slope = constrain(lroundf(s), INT16_MIN, INT16_MAX);
+}
@@ -0,0 +1,248 @@
+#include "hal.h"
+#include "triac.h"
+#include <Arduino.h>
+#include <avr/sleep.h>
+
+/**
+ * @brief Configures the hardware used to fire the triac.
+ * 
+ * The timer B1 counts the delay. When it is done, its capture event starts
+ * the timer B2 through the event system, which outputs a GATE_PULSE_US pulse.
+ * The CCL LUT2 copies that output to its own pin, PD3, which is TRIAC_PIN.
+ * 
+ *   TCB1 (delay) --CAPT event--> TCB2 (pulse) --WO--> LUT2 --> PD3
+ * 
+ * So the triac is fired without any interrupt. The Arduino core only uses B1
+ * for analogWrite() on D3, which is a button here.
+ * 
+ * The INTER_PIN (PB1) edges are routed to event channel 0. The timer B0 runs
+ * freely at 8MHz and captures them, which is how firingLatency() knows when
+ * the last pulse started. setEdgeStart() also lets them start B1, so the
+ * count begins without waiting for the zero crossing interrupt.
+ */
+void hal::setupFiringTimer()
+{
+    // Setup the timer B1 with /64 prescaler.
+    // Which is a ~4us ticks, it counts once and stops.
+    TCB1.CTRLA = TCB_CLKSEL_CLKTCA_gc;
+    TCB1.CTRLB = TCB_CNTMODE_SINGLE_gc;
+    TCB1.INTFLAGS = TCB_CAPT_bm;
+    TCB1.INTCTRL = 0;
+
+    // The timer B2 with /2 prescaler outputs a single pulse when B1 is done
+    EVSYS.CHANNEL2 = EVSYS_GENERATOR_TCB1_CAPT_gc;
+    EVSYS.USERTCB2 = EVSYS_CHANNEL_CHANNEL2_gc;
+
+    TCB2.CTRLA = TCB_CLKSEL_CLKDIV2_gc;
+    TCB2.CTRLB = TCB_CNTMODE_SINGLE_gc | TCB_CCMPEN_bm;
+    TCB2.EVCTRL = TCB_CAPTEI_bm;
+    TCB2.CCMP = (F_CPU / 2000000UL) * GATE_PULSE_US;
+    TCB2.CNT = TCB2.CCMP;
+    TCB2.INTCTRL = 0;
+    TCB2.CTRLA |= TCB_ENABLE_bm;
+
+    // The timer B0 with /2 prescaler timestamps the zero crossing pulses
+    EVSYS.CHANNEL0 = EVSYS_GENERATOR_PORT1_PIN1_gc;
+    EVSYS.USERTCB0 = EVSYS_CHANNEL_CHANNEL0_gc;
+
+    TCB0.CTRLA = TCB_CLKSEL_CLKDIV2_gc;
+    TCB0.CTRLB = TCB_CNTMODE_CAPT_gc;
+    TCB0.EVCTRL = TCB_CAPTEI_bm;
+    TCB0.INTCTRL = 0;
+    TCB0.CTRLA |= TCB_ENABLE_bm;
+
+    // LUT2 output = TCB2 output
+    CCL.LUT2CTRLB = CCL_INSEL0_TCB_gc | CCL_INSEL1_MASK_gc;
+    CCL.LUT2CTRLC = CCL_INSEL2_MASK_gc;
+    CCL.TRUTH2 = 0x02;
+
+    setHardwareGate(true);
+}
+
+/**
+ * @brief Lets the peripherals drive the triac gate when @a enabled. Otherwise
+ * the firing interrupt calls Triac::timeout() which pulses TRIAC_PIN itself.
+ */
+void hal::setHardwareGate(bool enabled)
+{
+    // The LUT can only be changed while the CCL is disabled
+    CCL.CTRLA = 0;
+
+    if(enabled)
+    {
+        TCB1.INTCTRL = 0;
+        CCL.LUT2CTRLA = CCL_OUTEN_bm | CCL_ENABLE_bm;
+        CCL.CTRLA = CCL_ENABLE_bm;
+    }
+    else
+    {
+        CCL.LUT2CTRLA = 0;
+        TCB1.INTFLAGS = TCB_CAPT_bm;
+        TCB1.INTCTRL = TCB_CAPT_bm;
+    }
+}
+
+/**
+ * @brief When @a enabled, the zero crossing rising edge starts the counter
+ * through the event system, for the length set by setFiringTicks().
+ * Otherwise it has to be started by startFiringTimer().
+ */
+void hal::setEdgeStart(bool enabled)
+{
+    TCB1.CTRLA &= ~TCB_ENABLE_bm;
+
+    if(enabled)
+    {
+        EVSYS.USERTCB1 = EVSYS_CHANNEL_CHANNEL0_gc;
+        TCB1.EVCTRL = TCB_CAPTEI_bm;
+        TCB1.CNT = TCB1.CCMP;
+        TCB1.CTRLA |= TCB_ENABLE_bm;
+    }
+    else
+    {
+        TCB1.EVCTRL = 0;
+        EVSYS.USERTCB1 = EVSYS_CHANNEL_OFF_gc;
+    }
+}
+
+/**
+ * @brief Sets how many ticks the counter counts when started by an edge. Not
+ * to be called while it is counting.
+ */
+void hal::setFiringTicks(uint16_t ticks)
+{
+    TCB1.CCMP = ticks;
+}
+
+/**
+ * @brief Restart the counter so it counts from 0 to @a ticks, then fires the
+ * triac.
+ */
+void hal::startFiringTimer(uint16_t ticks)
+{
+    TCB1.CTRLA &= ~TCB_ENABLE_bm;
+    TCB1.CCMP = ticks;
+    TCB1.CNT = 0;
+    TCB1.CTRLA |= TCB_ENABLE_bm;
+}
+
+/**
+ * @brief Prevents the counter from reaching the end.
+ */
+void hal::stopFiringTimer()
+{
+    TCB1.CTRLA &= ~TCB_ENABLE_bm;
+}
+
+/**
+ * @brief Whether the counter is currently counting
+ */
+bool hal::isFiringTimerRunning()
+{
+    return TCB1.STATUS & TCB_RUN_bm ? true : false;
+}
+
+/**
+ * @brief Returns the microseconds between the last zero crossing rising edge
+ * and the counter start, or -1 if the counter is not running.
+ * 
+ * The counter moves every 4us, so this includes when in that tick it started.
+ */
+long hal::firingLatency()
+{
+    uint8_t sreg = SREG;
+    cli();
+    uint16_t elapsed = TCB0.CNT - TCB0.CCMP;
+    uint16_t ticks   = TCB1.CNT;
+    bool     running = TCB1.STATUS & TCB_RUN_bm;
+    SREG = sreg;
+
+    if(!running)
+        return -1;
+
+    return (long)(elapsed / (F_CPU / 2000000UL)) - (long)ticks * FIRING_TICK_US;
+}
+
+/**
+ * @brief Drives the triac gate directly. Only works while the hardware gate is
+ * disabled, the LUT owns the pin otherwise.
+ */
+void hal::setGate(bool on)
+{
+    if(on)
+        VPORTD.OUT |= PIN3_bm;
+    else
+        VPORTD.OUT &= ~PIN3_bm;
+}
+
+/**
+ * @brief Whether an EEPROM erase/write cycle is still running. Writing a byte
+ * meanwhile would wait for it to finish.
+ */
+bool hal::eepromBusy()
+{
+    return NVMCTRL.STATUS & NVMCTRL_EEBUSY_bm;
+}
+
+/**
+ * @brief Sleeps until the next interrupt, the millis() tick of the timer B3
+ * at the latest. In idle mode the peripherals keep running, the firing timers
+ * included.
+ */
+void hal::idle()
+{
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+    sleep_cpu();
+    sleep_disable();
+}
+
+namespace
+{
+void (*volatile _tickHandler)() = nullptr;
+}
+
+/**
+ * @brief Calls @a handler from an interrupt every @a ms milliseconds, at most
+ * 2 seconds.
+ *
+ * The RTC counts the internal 32.768kHz oscillator and overflows every
+ * period. It is not used by the Arduino core and keeps running in standby.
+ * The oscillator is only accurate to a few percent, the handler should
+ * measure the actual period if it matters.
+ */
+void hal::setupTick(uint16_t ms, void (*handler)())
+{
+    _tickHandler = handler;
+
+    while(RTC.STATUS)
+        ;
+
+    RTC.CLKSEL   = RTC_CLKSEL_INT32K_gc;
+    RTC.PER      = (uint16_t)(ms * 32768UL / 1000 - 1);
+    RTC.CNT      = 0;
+    RTC.INTFLAGS = RTC_OVF_bm;
+    RTC.INTCTRL  = RTC_OVF_bm;
+    RTC.CTRLA    = RTC_PRESCALER_DIV1_gc | RTC_RUNSTDBY_bm | RTC_RTCEN_bm;
+}
+
+/**
+ * @brief ISR called when the RTC overflows, see setupTick()
+ */
+ISR(RTC_CNT_vect)
+{
+    RTC.INTFLAGS = RTC_OVF_bm;
+    if(_tickHandler)
+        _tickHandler();
+}
+
+/**
+ * @brief ISR called when the counter finished counting, only enabled when the
+ * gate is driven from software.
+ * It resets interrupt flags and call the proper interrupt method.
+ */
+ISR(TCB1_INT_vect)
+{
+  TCB1.INTFLAGS = TCB_CAPT_bm;
+  Triac::timeout();
+}
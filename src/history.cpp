@@ -0,0 +1,127 @@
+#include "history.h"
+#include "power.h"
+
+#include <Arduino.h>
+
+History _history;
+
+/**
+ * @brief Starts the first period
+ */
+void History::setup()
+{
+    setPeriod(period);
+}
+
+/**
+ * @brief Forgets everything recorded and starts a new period
+ */
+void History::clear()
+{
+    _head    = 0;
+    _count   = 0;
+    _samples = 0;
+    _powerSum = 0;
+    revision++;
+
+    periodTimer.restart();
+    periodTimer.setDeadline(period * 1000UL);
+}
+
+/**
+ * @brief Sets the @a s seconds each entry covers. The entries already recorded
+ * covered another duration, so they are cleared.
+ */
+void History::setPeriod(uint16_t s)
+{
+    period = s ? s : HISTORY_PERIOD;
+    clear();
+}
+
+/**
+ * @brief Returns the period @a step places after @a s in the list the user
+ * picks from: 30s to 10min.
+ */
+uint16_t History::nextPeriod(uint16_t s, int step)
+{
+    static const uint16_t periods[] = {30, 60, 120, 300, 600};
+    const int count = sizeof(periods)/sizeof(periods[0]);
+
+    int i = 0;
+    while(i < count && periods[i] != s)
+        i++;
+
+    return periods[(i + step + count) % count];
+}
+
+/**
+ * @brief Adds a reading to the current period: the @a temperature in
+ * 1/TEMP_ONE C, the @a setpoint in tenths of C and the @a power in 1/100 %.
+ */
+void History::add(int16_t temperature, int setpoint, unsigned int power)
+{
+    if(!_samples)
+    {
+        _min = temperature;
+        _max = temperature;
+    }
+    else if(temperature < _min)
+        _min = temperature;
+    else if(temperature > _max)
+        _max = temperature;
+
+    _powerSum += power;
+    _samples++;
+    _setpoint = setpoint / 5;
+}
+
+/**
+ * @brief Closes the current period and starts the next one. A period without
+ * any reading does not make an entry.
+ */
+void History::close()
+{
+    periodTimer.restart();
+
+    if(!_samples)
+        return;
+
+    Entry& e = _entries[_head];
+    e.min      = _min;
+    e.max      = _max;
+    e.power    = (_powerSum / _samples + POWER_MAX/200) / (POWER_MAX/100);
+    e.setpoint = _setpoint;
+
+    _head = (_head + 1) % HISTORY_LEN;
+    if(_count < HISTORY_LEN)
+        _count++;
+
+    _samples  = 0;
+    _powerSum = 0;
+    revision++;
+}
+
+/**
+ * @brief Called when the current period is over
+ */
+void History::periodEnded()
+{
+    _history.close();
+}
+
+/**
+ * @brief Returns how many entries are recorded
+ */
+uint8_t History::size() const
+{
+    return _count;
+}
+
+/**
+ * @brief Returns the entry @a i, 0 being the oldest
+ */
+const History::Entry& History::at(uint8_t i) const
+{
+    uint8_t start = (_head + HISTORY_LEN - _count) % HISTORY_LEN;
+    return _entries[(start + i) % HISTORY_LEN];
+}
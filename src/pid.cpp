@@ -0,0 +1,90 @@
+#include "pid.h"
+#include <math.h>
+
+/**
+ * @brief Makes sure the gains are usable, falls back to the defaults if not.
+ * They may come from an uninitialised EEPROM.
+ */
+void Pid::setup()
+{
+    if(isnan(kp) || isinf(kp) || kp < 0 ||
+       isnan(ki) || isinf(ki) || ki < 0 ||
+       isnan(kd) || isinf(kd) || kd < 0)
+    {
+        kp = PID_KP;
+        ki = PID_KI;
+        kd = PID_KD;
+    }
+}
+
+/**
+ * @brief Sets the proportional @a p, integral @a i and derivative @a d gains
+ */
+void Pid::setGains(float p, float i, float d)
+{
+    kp = p;
+    ki = i;
+    kd = d;
+}
+
+/**
+ * @brief Sets the range of the output, the integral term is kept in that range
+ * too.
+ */
+void Pid::setLimits(float min, float max)
+{
+    outMin = min;
+    outMax = max;
+
+    integral = clamp(integral);
+    output   = clamp(output);
+}
+
+/**
+ * @brief Re-engages the regulator. The next compute() will start from @a out.
+ */
+void Pid::reset(float out)
+{
+    output  = clamp(out);
+    _primed = false;
+}
+
+/**
+ * @brief Computes the output for the measured @a input, @a dt seconds after
+ * the previous measurement.
+ */
+float Pid::compute(float setpoint, float input, float dt)
+{
+    float error = setpoint - input;
+
+    if(!_primed || dt <= 0)
+    {
+        // Bumpless transfer: the integral absorbs what the proportional term
+        // would change.
+        integral   = clamp(output - kp * error);
+        derivative = 0;
+        lastInput  = input;
+        _primed    = true;
+    }
+    else
+    {
+        integral = clamp(integral + ki * error * dt);
+
+        float tf = kp > 0 ? kd / (kp * PID_N) : 0;
+        derivative += ((input - lastInput) / dt - derivative) * dt / (tf + dt);
+        lastInput = input;
+    }
+
+    output = clamp(kp * error + integral - kd * derivative);
+    return output;
+}
+
+/**
+ * @brief Keeps @a v within the output limits
+ */
+float Pid::clamp(float v) const
+{
+    if(v < outMin) return outMin;
+    if(v > outMax) return outMax;
+    return v;
+}
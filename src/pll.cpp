@@ -0,0 +1,178 @@
+#include "pll.h"
+
+/**
+ * @brief Forgets everything, the loop has to acquire the mains again
+ */
+void Pll::reset()
+{
+    locked      = false;
+    glitches    = 0;
+    _hasRise    = false;
+    _lastCenter = 0;
+    _acquired   = 0;
+    _misses     = 0;
+}
+
+/**
+ * @brief Goes back to acquiring the mains, keeps the statistics
+ */
+void Pll::unlock()
+{
+    locked      = false;
+    _lastCenter = 0;
+    _acquired   = 0;
+}
+
+/**
+ * @brief The zero crossing pulse started at @a now
+ */
+void Pll::rising(unsigned long now)
+{
+    _rise    = (uint32_t)now << PLL_SHIFT;
+    _hasRise = true;
+}
+
+/**
+ * @brief The zero crossing pulse ended at @a now, its middle is where the
+ * current crossed 0.
+ */
+void Pll::falling(unsigned long now)
+{
+    if(!_hasRise)
+        return;
+
+    _hasRise = false;
+
+    uint32_t width = ((uint32_t)now << PLL_SHIFT) - _rise;
+    if(width < ((uint32_t)PLL_MIN_PULSE << PLL_SHIFT) ||
+       width > ((uint32_t)PLL_MAX_PULSE << PLL_SHIFT))
+    {
+        glitches++;
+        return;
+    }
+
+    uint32_t center = _rise + width/2;
+
+    if(!locked)
+    {
+        acquire(center, width);
+        return;
+    }
+
+    int32_t error = (int32_t)(center - _zero);
+
+    // The mains went away for too long, start again from scratch
+    if(error > (int32_t)(_period * PLL_MAX_MISSES))
+    {
+        unlock();
+        return;
+    }
+
+    // Catch up with the half-cycles we did not see
+    while(error > (int32_t)(_period/2))
+    {
+        _zero += _period;
+        error -= _period;
+        _misses++;
+    }
+
+    if(error >  ((int32_t)PLL_WINDOW << PLL_SHIFT) ||
+       error < -((int32_t)PLL_WINDOW << PLL_SHIFT))
+    {
+        glitches++;
+        if(++_misses > PLL_MAX_MISSES)
+            unlock();
+        return;
+    }
+
+    _misses = 0;
+
+    // Predict the next zero and nudge the loop
+    _zero   += _period + (error >> PLL_KP_SHIFT);
+    _period += error >> PLL_KI_SHIFT;
+    _pulse  += ((int32_t)(width - _pulse)) >> 3;
+}
+
+/**
+ * @brief Measures the half period until enough consecutive ones agree, then
+ * locks on the last zero.
+ */
+void Pll::acquire(uint32_t center, uint32_t width)
+{
+    uint32_t period = center - _lastCenter;
+    _lastCenter = center;
+
+    if(period < ((uint32_t)PLL_MIN_HALF << PLL_SHIFT) ||
+       period > ((uint32_t)PLL_MAX_HALF << PLL_SHIFT))
+    {
+        _acquired = 0;
+        return;
+    }
+
+    int32_t diff = (int32_t)(period - _period);
+    if(_acquired == 0 || diff > (int32_t)(_period >> 6) || diff < -(int32_t)(_period >> 6))
+    {
+        // First one, or it does not agree with the previous ones (~1.5%)
+        _period   = period;
+        _pulse    = width;
+        _acquired = 1;
+        return;
+    }
+
+    _period += diff >> 2;
+    _pulse  += ((int32_t)(width - _pulse)) >> 2;
+
+    if(++_acquired >= PLL_ACQUIRE)
+    {
+        _zero   = center + _period;
+        _misses = 0;
+        locked  = true;
+    }
+}
+
+/**
+ * @brief Whether a rising edge at @a now is where the next zero crossing pulse
+ * is expected.
+ */
+bool Pll::expectsRise(unsigned long now) const
+{
+    int32_t error = (int32_t)((((uint32_t)now << PLL_SHIFT) + _pulse/2) - _zero);
+
+    return error <=  ((int32_t)PLL_WINDOW << PLL_SHIFT) &&
+           error >= -((int32_t)PLL_WINDOW << PLL_SHIFT);
+}
+
+/**
+ * @brief Returns how many microseconds there are between @a now and @a offset
+ * microseconds after the next predicted zero. Negative if it is already past.
+ */
+long Pll::timeTo(unsigned long now, unsigned int offset) const
+{
+    uint32_t target = _zero + ((uint32_t)offset << PLL_SHIFT);
+
+    return (int32_t)(target - ((uint32_t)now << PLL_SHIFT)) >> PLL_SHIFT;
+}
+
+/**
+ * @brief The tracked half period, in us
+ */
+unsigned int Pll::halfPeriod() const
+{
+    return _period >> PLL_SHIFT;
+}
+
+/**
+ * @brief The average width of the zero crossing pulses, in us
+ */
+unsigned int Pll::pulseWidth() const
+{
+    return _pulse >> PLL_SHIFT;
+}
+
+/**
+ * @brief The mains frequency, 50 or 60Hz
+ */
+uint8_t Pll::frequency() const
+{
+    return halfPeriod() < 9167 ? 60 : 50;
+}
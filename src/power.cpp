@@ -0,0 +1,116 @@
+#include "power.h"
+#include <Arduino.h>
+
+namespace
+{
+
+constexpr double Pi = 3.14159265358979323846;
+
+/**
+ * @brief sin(x) for x in [-pi, pi], Taylor series
+ */
+constexpr double sine(double x)
+{
+    double term = x;
+    double sum  = x;
+
+    for(int n = 1; n < 12; n++)
+    {
+        term *= -x * x / ((2*n) * (2*n + 1));
+        sum  += term;
+    }
+
+    return sum;
+}
+
+/**
+ * @brief Fraction of the full power delivered when firing at @a a (0..1) of
+ * the half-cycle.
+ */
+constexpr double delivered(double a)
+{
+    // sin(2.pi.a) = -sin(2.pi.a - pi), which is in range
+    return 1 - a - sine(2*Pi*a - Pi) / (2*Pi);
+}
+
+/**
+ * @brief The firing angle delivering @a p (0..1), found by bisection since the
+ * delivered power only decreases with the angle.
+ */
+constexpr double angleFor(double p)
+{
+    double low  = 0;
+    double high = 1;
+
+    for(int i = 0; i < 32; i++)
+    {
+        double mid = (low + high) / 2;
+        if(delivered(mid) > p)
+            low = mid;
+        else
+            high = mid;
+    }
+
+    return (low + high) / 2;
+}
+
+struct Table
+{
+    uint16_t angle[POWER_STEPS + 1];
+};
+
+/**
+ * @brief Firing angles in 1/65535 of the half-cycle, for a power going from 0
+ * to full in POWER_STEPS steps.
+ */
+constexpr Table makeTable()
+{
+    Table t = {};
+
+    // Both ends are exact, the curve is too flat there for the bisection
+    t.angle[0] = 65535;
+    for(int i = 1; i < POWER_STEPS; i++)
+        t.angle[i] = static_cast<uint16_t>(angleFor(static_cast<double>(i) / POWER_STEPS) * 65535 + 0.5);
+    t.angle[POWER_STEPS] = 0;
+
+    return t;
+}
+
+/**
+ * @brief More power always means firing earlier
+ */
+constexpr bool isDecreasing(const Table& t)
+{
+    for(int i = 0; i < POWER_STEPS; i++)
+        if(t.angle[i + 1] >= t.angle[i])
+            return false;
+
+    return true;
+}
+
+constexpr Table table PROGMEM = makeTable();
+
+static_assert(isDecreasing(table), "The firing angle must decrease with the power");
+static_assert(table.angle[POWER_STEPS/2] >= 32766 && table.angle[POWER_STEPS/2] <= 32769,
+              "Half the power is fired at the middle of the half-cycle");
+
+}
+
+/**
+ * @brief Returns the firing angle, in 1/65535 of the half-cycle, that delivers
+ * the power @a p (0..POWER_MAX).
+ */
+uint16_t power::toAngle(unsigned int p)
+{
+    if(p >= POWER_MAX)
+        return 0;
+
+    uint32_t scaled = (uint32_t)p * POWER_STEPS;
+    uint8_t  i      = scaled / POWER_MAX;
+    uint16_t frac   = scaled % POWER_MAX;
+
+    uint16_t a = pgm_read_word(&table.angle[i]);
+    uint16_t b = pgm_read_word(&table.angle[i + 1]);
+
+    return a - (uint32_t)(a - b) * frac / POWER_MAX;
+}
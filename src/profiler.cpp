@@ -0,0 +1,142 @@
+#include "profiler.h"
+#include <Arduino.h>
+
+Profiler _profiler;
+
+/**
+ * @brief Accumulates a duration of @a us microseconds
+ */
+void Probe::record(unsigned long us)
+{
+    if(us < min) min = us;
+    if(us > max) max = us;
+
+    uint8_t i = 0;
+    for(unsigned long v = us; (v >>= 1) && i < PROBE_BUCKETS - 1; )
+        i++;
+
+    if(buckets[i] == 0xFFFF)
+        halve();
+    while(sum > 0xFFFFFFFF - us)
+        halve();
+
+    count++;
+    sum += us;
+    buckets[i]++;
+}
+
+/**
+ * @brief Halves the histogram, the sum and the count together
+ */
+void Probe::halve()
+{
+    for(uint8_t i = 0; i < PROBE_BUCKETS; i++)
+        buckets[i] >>= 1;
+
+    sum   >>= 1;
+    count >>= 1;
+}
+
+/**
+ * @brief Forgets everything recorded so far
+ */
+void Probe::reset()
+{
+    *this = Probe();
+}
+
+/**
+ * @brief Returns the mean duration in microseconds
+ */
+unsigned long Probe::mean() const
+{
+    return count ? sum / count : 0;
+}
+
+
+
+// =============================================================================
+
+
+
+/**
+ * @brief Records a duration of @a us microseconds for @a stage
+ */
+void Profiler::record(uint8_t stage, unsigned long us)
+{
+    probes[stage].record(us);
+}
+
+/**
+ * @brief Copies the probe of @a stage. Interrupts are disabled during the copy
+ * since ISRs record their own durations.
+ */
+void Profiler::snapshot(uint8_t stage, Probe& probe) const
+{
+    noInterrupts();
+    probe = probes[stage];
+    interrupts();
+}
+
+/**
+ * @brief Forgets everything recorded so far
+ */
+void Profiler::reset()
+{
+    noInterrupts();
+    for(uint8_t i = 0; i < StageCount; i++)
+        probes[i].reset();
+    interrupts();
+}
+
+/**
+ * @brief Clears the @a stage probe only
+ */
+void Profiler::reset(uint8_t stage)
+{
+    noInterrupts();
+    probes[stage].reset();
+    interrupts();
+}
+
+/**
+ * @brief Returns the display name of @a stage
+ */
+const char* Profiler::name(uint8_t stage)
+{
+    switch(stage)
+    {
+    case Loop:          return "Loop";
+    case Temperature:   return "Sensor";
+    case Buttons:       return "Buttons";
+    case Render:        return "Render";
+    case ZeroCrossIsr:  return "Zero ISR";
+    case FiringIsr:     return "Fire ISR";
+    case FiringLatency: return "Fire lat";
+    case TickIsr:       return "Tick ISR";
+    case TickJitter:    return "Tick jit";
+    default:            return "?";
+    }
+}
+
+
+
+// =============================================================================
+
+
+
+/**
+ * @brief Starts timing @a stage
+ */
+ScopedProbe::ScopedProbe(uint8_t stage) :
+    _stage(stage),
+    _start(micros())
+{}
+
+/**
+ * @brief Records the time spent since construction
+ */
+ScopedProbe::~ScopedProbe()
+{
+    _profiler.record(_stage, micros() - _start);
+}
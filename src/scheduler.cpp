@@ -0,0 +1,141 @@
+#include "scheduler.h"
+#include "hal.h"
+
+#include <Arduino.h>
+
+Scheduler _scheduler;
+
+namespace
+{
+/**
+ * @brief Adds @a us microseconds to @a ms milliseconds and the @a rest of a
+ * millisecond accounted so far.
+ */
+void account(unsigned long& ms, uint16_t& rest, unsigned long us)
+{
+    us  += rest;
+    ms  += us / 1000;
+    rest = us % 1000;
+}
+}
+
+/**
+ * @brief Takes the @a count tasks at @a tasks, in priority order, and starts
+ * their periods.
+ */
+void Scheduler::setup(Task* t, uint8_t c)
+{
+    tasks = t;
+    count = c;
+
+    for(uint8_t i = 0; i < count; i++)
+    {
+        tasks[i].timer.setDeadline(tasks[i].period);
+        tasks[i].timer.restart();
+    }
+
+    _mark = micros();
+}
+
+/**
+ * @brief Runs the first task due. Returns false if none is.
+ */
+bool Scheduler::runNext()
+{
+    for(uint8_t i = 0; i < count; i++)
+    {
+        Task& t = tasks[i];
+
+        if(t.suspended)
+            continue;
+
+        if(t.signalled)
+            t.signalled = false;
+        else
+        {
+            unsigned long elapsed = t.timer.elapsedTime();
+            if(!t.period || elapsed < t.timer.deadline)
+                continue;
+
+            unsigned long late = elapsed - t.timer.deadline;
+            if(late > t.late)
+                t.late = late > 0xFFFF ? 0xFFFF : late;
+        }
+
+        t.timer.restart();
+
+        unsigned long start = micros();
+        t.run();
+        unsigned long duration = micros() - start;
+
+        t.runs++;
+        if(duration > t.longest)
+            t.longest = duration;
+        if(duration > t.budget)
+            t.overruns++;
+
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Sleeps until the next interrupt, to be called when no task is due
+ */
+void Scheduler::idle()
+{
+    unsigned long now = micros();
+    account(awake, _awakeUs, now - _mark);
+
+    hal::idle();
+
+    _mark = micros();
+    account(asleep, _asleepUs, _mark - now);
+    idles++;
+}
+
+/**
+ * @brief Runs the task @a i on the next pass, whatever its period. Meant to be
+ * called from the interrupt that gives it something to do.
+ */
+void Scheduler::signal(uint8_t i)
+{
+    tasks[i].signalled = true;
+}
+
+/**
+ * @brief Stops running the task @a i until resume()
+ */
+void Scheduler::suspend(uint8_t i)
+{
+    tasks[i].suspended = true;
+}
+
+/**
+ * @brief Runs the task @a i again, from the next pass on
+ */
+void Scheduler::resume(uint8_t i)
+{
+    if(tasks[i].suspended)
+    {
+        tasks[i].suspended = false;
+        tasks[i].signalled = true;
+    }
+}
+
+/**
+ * @brief Runs the task @a i every @a period ms from now on, or only when
+ * signalled if 0. Does nothing if that is already its period.
+ */
+void Scheduler::setPeriod(uint8_t i, uint16_t period)
+{
+    Task& t = tasks[i];
+
+    if(t.period == period)
+        return;
+
+    t.period = period;
+    t.timer.setDeadline(period);
+    t.timer.restart();
+}
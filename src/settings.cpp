@@ -0,0 +1,183 @@
+#include "settings.h"
+#include "hal.h"
+
+#include <Arduino.h>
+#include <EEPROM.h>
+
+Settings _settings;
+
+// Where older versions saved each value, ints were 2 bytes
+#define LEGACY_IDEAL_ADDR 0
+#define LEGACY_TIMER_ADDR 2
+#define LEGACY_BIAS_ADDR  4
+#define LEGACY_KP_ADDR    8
+#define LEGACY_KI_ADDR    12
+#define LEGACY_KD_ADDR    16
+
+/**
+ * @brief Reads the newest valid record into config, or what older versions
+ * saved if there is none.
+ */
+void Settings::load()
+{
+    bool found = false;
+
+    for(uint8_t i = 0; i < slotCount(); i++)
+    {
+        Record r;
+        EEPROM.get(i * sizeof(Record), r);
+
+        if(r.version != SETTINGS_VERSION ||
+           r.crc != crc(reinterpret_cast<const uint8_t*>(&r), offsetof(Record, crc)))
+            continue;
+
+        // Sequence numbers wrap around, newer is less than half a turn ahead
+        if(!found || (int16_t)(r.sequence - sequence) > 0)
+        {
+            config   = r.config;
+            sequence = r.sequence;
+            slot     = i;
+            found    = true;
+        }
+    }
+
+    if(!found)
+    {
+        loadLegacy();
+
+        // The next commit goes to the first slot
+        slot = slotCount() - 1;
+    }
+}
+
+/**
+ * @brief Starts a commit once the changes settled, and writes the next byte
+ * of the one running if the EEPROM is ready for it.
+ *
+ * Bytes that already hold the right value are skipped without writing them.
+ * The EEPROM is not even read while busy: on the ATmega4809 that would halt
+ * the CPU until the write is done.
+ */
+void Settings::update()
+{
+    if(!isCommitting())
+    {
+        if(dirty && quietTimer.hasExpired())
+            startCommit();
+        return;
+    }
+
+    const uint8_t* image = reinterpret_cast<const uint8_t*>(&_image);
+
+    while(_written < sizeof(Record))
+    {
+        if(hal::eepromBusy())
+            return;
+
+        if(EEPROM.read(_addr + _written) != image[_written])
+        {
+            EEPROM.write(_addr + _written, image[_written]);
+            _written++;
+            return;
+        }
+
+        _written++;
+    }
+}
+
+/**
+ * @brief Schedules a commit of config, SETTINGS_QUIET milliseconds after the
+ * last change.
+ */
+void Settings::touch()
+{
+    dirty = true;
+    quietTimer.restart();
+    quietTimer.setDeadline(SETTINGS_QUIET);
+}
+
+/**
+ * @brief Whether a record is being written.
+ */
+bool Settings::isCommitting() const
+{
+    return _written < sizeof(Record);
+}
+
+/**
+ * @brief Returns how many records fit in the EEPROM.
+ */
+uint8_t Settings::slotCount()
+{
+    uint16_t n = EEPROM.length() / sizeof(Record);
+    return n > 255 ? 255 : n;
+}
+
+/**
+ * @brief CRC-16/CCITT of @a len bytes at @a data
+ */
+uint16_t Settings::crc(const uint8_t* data, uint16_t len)
+{
+    uint16_t crc = 0xFFFF;
+
+    while(len--)
+    {
+        crc ^= (uint16_t)*data++ << 8;
+        for(uint8_t i = 0; i < 8; i++)
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+
+    return crc;
+}
+
+/**
+ * @brief Reads the values older versions saved at fixed addresses. The ones
+ * that do not make sense are left to their default, or to the Controller to
+ * check.
+ *
+ * The timer used to be saved over the first half of the bias, so at most one
+ * of them is right. The timer is kept as is anyway, older versions used it
+ * that way: erased or overwritten, it never expires. Ideal was saved in whole
+ * degrees before being saved in tenths, nobody heats to less than 10C.
+ */
+void Settings::loadLegacy()
+{
+    config = Config();
+
+    int16_t ideal;
+    EEPROM.get(LEGACY_IDEAL_ADDR, ideal);
+    config.ideal = ideal >= 0 && ideal < 100 ? ideal * 10 : ideal;
+
+    EEPROM.get(LEGACY_TIMER_ADDR, config.timer);
+
+    float bias;
+    EEPROM.get(LEGACY_BIAS_ADDR, bias);
+    if(bias >= -5.0f && bias <= 5.0f)
+        config.bias[0] = lroundf(bias * 10);
+
+    // The Pid checks its own gains
+    EEPROM.get(LEGACY_KP_ADDR, config.kp);
+    EEPROM.get(LEGACY_KI_ADDR, config.ki);
+    EEPROM.get(LEGACY_KD_ADDR, config.kd);
+}
+
+/**
+ * @brief Snapshots config into the next slot's record.
+ */
+void Settings::startCommit()
+{
+    // Zeroes the padding too, when there is any, the CRC covers it
+    memset(static_cast<void*>(&_image), 0, sizeof(_image));
+
+    _image.version  = SETTINGS_VERSION;
+    _image.sequence = sequence + 1;
+    _image.config   = config;
+    _image.crc      = crc(reinterpret_cast<const uint8_t*>(&_image), offsetof(Record, crc));
+
+    sequence = _image.sequence;
+    slot     = (slot + 1) % slotCount();
+    _addr    = slot * sizeof(Record);
+    _written = 0;
+    dirty    = false;
+    commits++;
+}
@@ -0,0 +1,143 @@
+#include "telemetry.h"
+#include "controller.h"
+#include "thermometer.h"
+#include "triac.h"
+#include "ui.h"
+
+#include <Arduino.h>
+
+Telemetry _telemetry;
+
+#define TELEMETRY_MASK (TELEMETRY_BUFFER - 1)
+
+/**
+ * @brief Opens the serial port and starts sampling
+ */
+void Telemetry::setup()
+{
+    Serial.begin(TELEMETRY_BAUD);
+
+    sampleTimer.setDeadline(TELEMETRY_PERIOD);
+    sampleTimer.restart();
+}
+
+/**
+ * @brief Called by the main loop. Takes a sample when it is time to and hands
+ * what the UART has room for.
+ */
+void Telemetry::update()
+{
+    if(sampleTimer.hasExpired())
+    {
+        sampleTimer.restart();
+        sample();
+    }
+
+    drain();
+}
+
+/**
+ * @brief Queues a frame made of the @a len bytes at @a data, at most
+ * TELEMETRY_PAYLOAD. Returns false, and counts a drop, if it does not fit.
+ */
+bool Telemetry::send(const uint8_t* data, uint8_t len)
+{
+    if(len > TELEMETRY_PAYLOAD)
+        return false;
+
+    uint8_t frame[frameMax];
+    uint8_t n = encode(data, len, frame);
+
+    if(n > TELEMETRY_MASK - pending())
+    {
+        drops++;
+        return false;
+    }
+
+    for(uint8_t i = 0; i < n; i++)
+    {
+        _buffer[_head] = frame[i];
+        _head = (_head + 1) & TELEMETRY_MASK;
+    }
+
+    return true;
+}
+
+/**
+ * @brief COBS encodes the @a len bytes at @a data, at most 253, into
+ * @a frame, followed by the 0 delimiter. Returns the length of the frame.
+ *
+ * Each 0 is replaced by the distance to the next one, the first byte being
+ * the distance to the first 0.
+ */
+uint8_t Telemetry::encode(const uint8_t* data, uint8_t len, uint8_t* frame)
+{
+    uint8_t code = 0; // Where the distance to the next 0 goes
+    uint8_t n    = 1;
+
+    for(uint8_t i = 0; i < len; i++)
+    {
+        if(data[i])
+            frame[n++] = data[i];
+        else
+        {
+            frame[code] = n - code;
+            code = n++;
+        }
+    }
+
+    frame[code] = n - code;
+    frame[n++]  = 0;
+
+    return n;
+}
+
+/**
+ * @brief How many bytes are waiting for the UART
+ */
+uint16_t Telemetry::pending() const
+{
+    return (_head - _tail) & TELEMETRY_MASK;
+}
+
+/**
+ * @brief Queues a sample of the current state
+ */
+void Telemetry::sample()
+{
+    Sample s;
+    s.type        = TELEMETRY_SAMPLE;
+    s.sequence    = sequence++;
+    s.time        = millis();
+    s.temperature = _thermo.temperature;
+    s.raw         = _thermo.raw;
+    s.slope       = _thermo.trend.slope;
+    s.ideal       = _controller.ideal;
+    s.power       = _triac.power;
+    s.triacDelay  = _triac.triacDelay > 0xFFFF ? 0xFFFF : _triac.triacDelay;
+    s.syncDelay   = _triac.syncDelay  > 0xFFFF ? 0xFFFF : _triac.syncDelay;
+    s.loopTime    = _ui.loopTime > 0xFFFF ? 0xFFFF : _ui.loopTime;
+    s.loopMax     = _loopMax;
+    s.state       = _controller.state;
+    s.powerState  = _controller.powerState;
+    s.drops       = drops;
+
+    _loopMax = 0;
+
+    send(reinterpret_cast<const uint8_t*>(&s), sizeof(s));
+}
+
+/**
+ * @brief Moves what the transmit buffer of the core has room for, so write()
+ * never waits.
+ */
+void Telemetry::drain()
+{
+    int room = Serial.availableForWrite();
+
+    while(room-- > 0 && _tail != _head)
+    {
+        Serial.write(_buffer[_tail]);
+        _tail = (_tail + 1) & TELEMETRY_MASK;
+    }
+}
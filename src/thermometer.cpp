@@ -1,6 +1,5 @@
 #include "thermometer.h"
 #include <Arduino.h>
-#include <math.h>
 
 Thermometer _thermo;
 
@@ -21,33 +20,244 @@ void Thermometer::setup()
 {
     pinMode(TEMP_PIN, INPUT_PULLUP);
 
-    if(isnan(bias) || isinf(bias) || !(bias >= -5.0f && bias <= 5.0f))
-        bias = 0;
+    for(Sensor& s : sensors)
+    {
+        if(s.bias < -THERMO_MAX_BIAS || s.bias > THERMO_MAX_BIAS)
+            s.bias = 0;
+
+        if(s.weight > THERMO_MAX_WEIGHT)
+            s.weight = 1;
+    }
+
+    setAggregate(aggregate);
+    setFilter(filter.mode);
 
     _dallas.begin();
 
-    // These 2 lines allow us to do async readings.
-    // It sounds complex but it's actually pretty simple
-    // You just need to check the convertion is completed before you read a
-    // value. Instead of letting the library waiting and doing nothing, The
-    // controller can do other meaningful things in the meantime.
-    _dallas.setCheckForConversion(true);
+    // These lines allow us to do async readings.
+    // The conversion time only depends on the resolution, so there is no need
+    // to ask the sensor whether it is done: the controller does other
+    // meaningful things until it is due, then reads the value.
+    // The resolution is only kept in the sensor scratchpad. It can change
+    // often in adaptive mode and copying it to the sensor EEPROM would both
+    // wear it and block the bus for 20ms each time.
+    _dallas.setCheckForConversion(false);
     _dallas.setWaitForConversion(false);
-    _dallas.getAddress(_addr, 0);
+    _dallas.setAutoSaveScratchPad(false);
+
+    sensorCount = 0;
+    while(sensorCount < THERMO_MAX_SENSORS &&
+          _dallas.getAddress(sensors[sensorCount].addr, sensorCount))
+        sensorCount++;
 
-    delay(500);
+    setResolution(resolution);
+    startConversion();
 }
 
 /**
- * @brief Checks if the conversion is finished. If it is the case, read the
- * value and ask for a new conversion. If not, just pass and continue do useful
- * stuff.
+ * @brief Reads the values once the conversion is due and asks for a new
+ * conversion. If not, just pass and continue do useful stuff.
+ * 
+ * The raw values are used as is, in 1/128 C. A disconnected sensor is not a
+ * reading, when none answers there is no new temperature. Otherwise the
+ * aggregate goes through the filter and feeds the trend.
  */
 void Thermometer::update()
 {
-    if(_dallas.isConversionComplete())
+    if(!conversionTimer.hasExpired())
+        return;
+
+    for(uint8_t i = 0; i < sensorCount; i++)
+    {
+        Sensor& s = sensors[i];
+        int16_t raw = _dallas.getTemp(s.addr);
+
+        s.present = raw != DEVICE_DISCONNECTED_RAW;
+        if(s.present)
+            s.temperature = raw + utils::fromTenths(s.bias);
+    }
+
+    if(combine())
+    {
+        samplePeriod = sampleTimer.elapsedTime();
+        sampleTimer.restart();
+
+        temperature = filter.update(raw, samplePeriod, _bits);
+        trend.update(temperature, millis());
+        _newReading = true;
+    }
+
+    if(resolution == THERMO_ADAPTIVE)
+    {
+        int16_t d = abs(temperature - target);
+
+        if(d <= THERMO_NEAR)
+            applyResolution(12);
+        else if(d > THERMO_FAR)
+            applyResolution(THERMO_FAST_BITS);
+    }
+
+    startConversion();
+}
+
+/**
+ * @brief Returns true once after each new temperature reading.
+ */
+bool Thermometer::hasNewReading()
+{
+    bool r = _newReading;
+    _newReading = false;
+    return r;
+}
+
+/**
+ * @brief Sets the resolution, from 9 to 12 bits, or THERMO_ADAPTIVE. Anything
+ * else falls back to THERMO_RESOLUTION.
+ *
+ * Adaptive mode starts precise, it goes fast at the next reading if the
+ * temperature is far from the target.
+ */
+void Thermometer::setResolution(uint8_t r)
+{
+    if(r != THERMO_ADAPTIVE && (r < 9 || r > 12))
+        r = THERMO_RESOLUTION;
+
+    resolution = r;
+    applyResolution(r == THERMO_ADAPTIVE ? 12 : r);
+}
+
+/**
+ * @brief Sets the temperature adaptive mode wants to be precise around, in
+ * 1/TEMP_ONE C.
+ */
+void Thermometer::setTarget(int16_t t)
+{
+    target = t;
+}
+
+/**
+ * @brief Returns the resolution of the running conversion, in bits.
+ */
+uint8_t Thermometer::bits() const
+{
+    return _bits;
+}
+
+/**
+ * @brief Sets how the sensor readings are combined, see Aggregate. Anything
+ * else falls back to Mean.
+ */
+void Thermometer::setAggregate(uint8_t a)
+{
+    aggregate = a < AggregateCount ? a : (uint8_t)Mean;
+}
+
+/**
+ * @brief Sets the filter, see Filter::Mode, and starts it over.
+ */
+void Thermometer::setFilter(uint8_t f)
+{
+    filter.setMode(f);
+    trend.reset();
+}
+
+/**
+ * @brief Returns how many sensors answered the last reading.
+ */
+uint8_t Thermometer::presentCount() const
+{
+    uint8_t n = 0;
+    for(uint8_t i = 0; i < sensorCount; i++)
+        n += sensors[i].present;
+
+    return n;
+}
+
+/**
+ * @brief Writes the resolution to the sensors, if it changed.
+ *
+ * A conversion already running keeps the resolution it started with, the new
+ * one applies from the next conversion.
+ */
+void Thermometer::applyResolution(uint8_t b)
+{
+    if(b == _bits)
+        return;
+
+    _dallas.setResolution(b);
+    _bits = b;
+}
+
+/**
+ * @brief Starts a conversion on all the sensors at once and schedules the
+ * reading for when it is due.
+ */
+void Thermometer::startConversion()
+{
+    _dallas.requestTemperatures();
+    conversionTimer.restart();
+    conversionTimer.setDeadline(_dallas.millisToWaitForConversion(_bits));
+}
+
+/**
+ * @brief Combines the readings of the sensors present into raw. Returns
+ * false, leaving raw as is, if none is.
+ *
+ * Weighted falls back to Mean when the weights of the sensors present add up
+ * to 0.
+ */
+bool Thermometer::combine()
+{
+    int32_t sum    = 0;
+    int32_t wsum   = 0;
+    int16_t weight = 0;
+    int16_t low    = INT16_MAX;
+    int16_t high   = INT16_MIN;
+    uint8_t n      = 0;
+
+    for(uint8_t i = 0; i < sensorCount; i++)
     {
-        temperature = _dallas.getTempC(_addr) + bias;
-        _dallas.requestTemperaturesByAddress(_addr);
+        const Sensor& s = sensors[i];
+        if(!s.present)
+            continue;
+
+        sum    += s.temperature;
+        wsum   += (int32_t)s.temperature * s.weight;
+        weight += s.weight;
+        n++;
+
+        if(s.temperature < low)
+            low = s.temperature;
+        if(s.temperature > high)
+            high = s.temperature;
+    }
+
+    if(!n)
+        return false;
+
+    switch(aggregate)
+    {
+    case Min:
+        raw = low;
+        break;
+
+    case Max:
+        raw = high;
+        break;
+
+    case Weighted:
+        if(weight)
+        {
+            raw = utils::divRound(wsum, weight);
+            break;
+        }
+        // fall through
+
+    default:
+    case Mean:
+        raw = utils::divRound(sum, n);
+        break;
     }
+
+    return true;
 }
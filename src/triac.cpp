@@ -1,6 +1,10 @@
 #include "triac.h"
+#include "hal.h"
+#include "power.h"
+#include "profiler.h"
 #include "utils.h"
 #include <Arduino.h>
+#include <util/atomic.h>
 
 Triac _triac;
 
@@ -16,47 +20,34 @@ void Triac::setup()
 }
 
 /**
- * @brief Sets the delay to wait between the current crossing 0 and the triac
- * being driven.
+ * @brief Sets the power delivered to the heater, from 0 to POWER_MAX.
  * 
- * More delay == less power
+ * In phase angle control, it is converted to the delay to wait between the
+ * current crossing 0 and the triac being driven, see power::toAngle().
+ *
+ * It is also called from the regulation tick interrupt, so everything it
+ * writes is written at once and interrupts are left as they were.
  */
-void Triac::setDelay(unsigned int us)
+void Triac::setPower(unsigned int p)
 {
-    if(triacDelay != us && us <= triacMax)
-    {
-        triacDelay = us;
-        updateTickCount();
-    }
-}
-
-/**
- * @brief Increase the delay by @a a
- */
-void Triac::incDelay(unsigned int a)
-{
-    triacDelay += a;
-    if(triacDelay > triacMax)
-        triacDelay = triacMax;
+    if(p > POWER_MAX)
+        p = POWER_MAX;
 
-    updateTickCount();
-}
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        power = p;
 
-/**
- * @brief Decrease the delay by @a a
- */
-void Triac::decDelay(unsigned int a)
-{
-    if(triacDelay <= a)
-        triacDelay = 0;
-    else
-        triacDelay -= a;
+        // Firing angle in us after the zero, minus the guard we always keep
+        unsigned long us = ((unsigned long)power::toAngle(p) * halfPeriod) >> 16;
+        us = us > FIRE_GUARD ? us - FIRE_GUARD : 0;
 
-    updateTickCount();
+        triacDelay = us < triacMax ? us : triacMax;
+        updateFiringOffset();
+    }
 }
 
 /**
- * @brief Detect the offset of the zero crossing detector.
+ * @brief Starts following the mains.
  * 
  * The electronic generate a short impusle when the current crosses 0. This
  * impulse starts a little bit before the actual zero and end a little bit after.
@@ -70,72 +61,209 @@ void Triac::decDelay(unsigned int a)
  * In theory, all impulses are exactly equal and you can take half of the
  * measured time to get the exact zero cross point.
  * 
- * In practice this is not true and your controller is not accurate enough for
- * that. So instead of halving the duration, we'll keep it. We'll even add a
- * little extra delay to be absolutely sure we will avoid flickers.
- * 
- * What you get is that
+ * In practice a single pulse is not accurate enough for that, so both edges
+ * are timestamped from an interrupt and fed to a phase-locked loop that
+ * averages them out and predicts where the next zero is going to be.
  * 
  *              ___                                ___
  * ____________|   |______________________________|   |_______________
  * 
  * --------------|----------------------------------|-----------------
  * 
- * =========|        |==========================|       |=============
- *                     \_ This is the actual available time to count
- *                        And it is way enough to drive a simple IR lamp.
+ * ===============| |==============================|  |================
+ *                    \_ This is the actual available time to count,
+ *                       only a small guard is kept around each zero.
+ * 
+ * The rest of the program keeps running, call updateSync() until it returns
+ * true.
  */
-void Triac::detectSync()
+void Triac::startSync()
 {
-    // Takes 100 pulse length and get the max one
-    for(int i = 0; i < 100; i++)
-    {
-        unsigned long pulse = pulseIn(INTER_PIN, HIGH, 15000);
+    firing = false;
+    pll.reset();
 
-        if(pulse == 0)
-            continue;
+    attachInterrupt(digitalPinToInterrupt(INTER_PIN),
+                    Triac::zeroDetected,
+                    CHANGE);
+}
+
+/**
+ * @brief Returns true once the Pll is locked on the mains. syncDelay and
+ * triacMax are then up to date.
+ */
+bool Triac::updateSync()
+{
+    if(!pll.locked)
+        return false;
 
-        if(pulse > syncDelay)
-            syncDelay = pulse;
+    unsigned int half, pulse;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        half  = pll.halfPeriod();
+        pulse = pll.pulseWidth();
     }
 
-    syncDelay += 300; // little extra to avoid timing issue
+    // The regulation tick may set the power meanwhile
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        // How long the pulse starts before the actual zero
+        halfPeriod = half;
+        syncDelay  = pulse/2;
+
+        // The triac has to be fired before the next pulse starts
+        triacMax = half - syncDelay - 2*FIRE_GUARD;
+
+        setPower(power);
+    }
 
-    // Update max delay allowed to avoid flicker
-    triacMax = 10000-syncDelay;
-    
-    if(triacDelay > triacMax)
-        triacDelay = triacMax;
+    return true;
+}
 
-    updateTickCount();
+/**
+ * @brief Stops following the mains
+ */
+void Triac::stopSync()
+{
+    detachInterrupt(digitalPinToInterrupt(INTER_PIN));
+    pll.locked = false;
 }
 
 /**
- * @brief Setup the interrupts so the triac can be driven
+ * @brief Lets the zero crossing pulses drive the triac
  */
 void Triac::turnOn()
 {
-    attachInterrupt(digitalPinToInterrupt(INTER_PIN),
-                    Triac::zeroDetected,
-                    RISING);
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        firing = true;
+        configure();
+    }
 }
 
 /**
- * @brief Remove the interrupt to avoid the triac being driven when not wanted
+ * @brief Avoids the triac being driven when not wanted
  */
 void Triac::turnOff()
 {
-    detachInterrupt(digitalPinToInterrupt(INTER_PIN));
-    digitalWrite(TRIAC_PIN, LOW);
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        firing = false;
+        configure();
+    }
+}
+
+/**
+ * @brief Chooses whether the gate pulse is produced by the peripherals
+ * (@a enabled) or by the firing interrupt. The latter is only there to measure
+ * how much time the interrupt costs, see the FiringIsr probe.
+ */
+void Triac::setHardwareGate(bool enabled)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        hardwareGate = enabled;
+        configure();
+    }
+
+    _profiler.reset(Profiler::FiringIsr);
 }
 
 /**
- * @brief Compute the number of ticks the hardware timer needs to count to
- * satisfy the delay we want to wait.
+ * @brief Chooses whether the firing timer is started by the zero crossing
+ * edge itself through the event system (@a enabled), or by the zero crossing
+ * interrupt.
+ * 
+ * The event system starts counting a fixed delay after the edge, there is no
+ * latency but the delay is counted from the pulse rather than from the Pll
+ * prediction, and a glitch on the detector starts it all the same. So the
+ * interrupt stays the default.
  */
-void Triac::updateTickCount()
+void Triac::setEdgeStart(bool enabled)
 {
-    tickCount = ((syncDelay + triacDelay)/4)-1;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        edgeStart = enabled;
+        configure();
+    }
+
+    _profiler.reset(Profiler::FiringLatency);
+}
+
+/**
+ * @brief Switches to burst fire when @a cycles is not 0, phase angle control
+ * otherwise.
+ * 
+ * In burst fire, the triac conducts whole half-cycles: the power is the
+ * fraction of the mains cycles let through, out of every @a cycles ones. It
+ * makes a lot less noise than chopping the sine wave and does not depend on
+ * the zero crossing timing, but only suits resistive loads.
+ */
+void Triac::setBurst(uint8_t cycles)
+{
+    if(cycles > BURST_MAX_CYCLES)
+        cycles = 0;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        burstCycles = cycles;
+        burstAcc    = 0;
+        configure();
+    }
+
+    updateFiringOffset();
+}
+
+/**
+ * @brief Sets the firing hardware up for the current modes. Interrupts must be
+ * disabled.
+ */
+void Triac::configure()
+{
+    stopCounter();
+    hal::setGate(false);
+    hal::setHardwareGate(hardwareGate && !burstCycles);
+    hal::setFiringTicks(edgeTicks);
+    hal::setEdgeStart(firing && edgeStart && !burstCycles);
+    ticksPending = false;
+}
+
+/**
+ * @brief Keeps the event system in step with the delay. The counter length
+ * can only change while it is not counting, this is called from the main loop
+ * until it happens.
+ */
+void Triac::update()
+{
+    if(!ticksPending)
+        return;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        if(!isRunning())
+        {
+            hal::setFiringTicks(edgeTicks);
+            ticksPending = false;
+        }
+    }
+}
+
+/**
+ * @brief Publishes the delay to the zero crossing interrupt, as the offset
+ * from the predicted zero at which the triac is fired.
+ */
+void Triac::updateFiringOffset()
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        firingOffset = FIRE_GUARD + triacDelay;
+
+        // Counted from the edge when it starts the timer
+        edgeTicks    = ((syncDelay + FIRE_GUARD + triacDelay)/FIRING_TICK_US)-1;
+        ticksPending = true;
+
+        // The same power in burst fire, as a number of cycles
+        burstOn = ((unsigned long)power * burstCycles + POWER_MAX/2) / POWER_MAX;
+    }
 }
 
 /**
@@ -143,26 +271,24 @@ void Triac::updateTickCount()
  */
 void Triac::setupCounter()
 {
-    // Setup the timer B2 with /64 prescaler.
-    // Which is a ~4us ticks
-    TCB2.CTRLA = TCB_CLKSEL_CLKTCA_gc;
-    TCB2.CTRLB = TCB_CNTMODE_INT_gc & ~TCB_CCMPEN_bm;
-    TCB2.INTFLAGS = TCB_CAPT_bm;
-    TCB2.INTCTRL = TCB_CAPT_bm;
+    hal::setupFiringTimer();
 }
 
 /**
- * @brief Restart the counter so it counts from 0 to tickCount and call
- * timeout() once it has done that.
+ * @brief Restart the counter so it calls timeout() firingOffset microseconds
+ * after the predicted zero. It is called at @a now, when the pulse started.
  */
-void Triac::startCounter()
+void Triac::startCounter(unsigned long now)
 {
     if(isRunning())
         return;
 
-    TCB2.CCMP = tickCount;
-    TCB2.CNT = 0;
-    TCB2.CTRLA |= TCB_ENABLE_bm;
+    long us = pll.timeTo(now, firingOffset);
+    if(us < 2*FIRING_TICK_US)
+        return;
+
+    tickCount = (us/FIRING_TICK_US)-1;
+    hal::startFiringTimer(tickCount);
 }
 
 /**
@@ -170,7 +296,7 @@ void Triac::startCounter()
  */
 void Triac::stopCounter()
 {
-    TCB2.CTRLA &= ~TCB_ENABLE_bm;
+    hal::stopFiringTimer();
 }
 
 /**
@@ -178,35 +304,79 @@ void Triac::stopCounter()
  */
 bool Triac::isRunning()
 {
-    return TCB2.CTRLA & TCB_ENABLE_bm ? true : false;
+    return hal::isFiringTimerRunning();
 }
 
 /**
- * @brief Interrupt called when the current crosses 0
+ * @brief Interrupt called on both edges of the zero crossing pulse. It starts
+ * the firing timer on the rising edge, unless the event system does it, or
+ * drives the gate in burst fire.
  */
 void Triac::zeroDetected()
 {
-    _triac.startCounter();
+    ScopedProbe probe(Profiler::ZeroCrossIsr);
+
+    unsigned long now = micros();
+
+    if(!digitalRead(INTER_PIN))
+    {
+        // How long after the rising edge the count started
+        long latency = hal::firingLatency();
+        if(latency >= 0)
+            _profiler.record(Profiler::FiringLatency, latency);
+
+        _triac.pll.falling(now);
+        return;
+    }
+
+    _triac.pll.rising(now);
+
+    bool expected = _triac.pll.locked && _triac.pll.expectsRise(now);
+
+    if(_triac.burstCycles)
+    {
+        if(!_triac.pll.locked)
+            hal::setGate(false);
+        else if(expected)
+            _triac.nextHalfCycle();
+    }
+    else if(_triac.firing && !_triac.edgeStart && expected)
+        _triac.startCounter(now);
 }
 
 /**
- * @brief Interrupt called when the counter reached tickCount.
+ * @brief Called in burst fire right before a zero crossing, decides whether
+ * the half-cycle about to start conducts. The gate is held for the whole
+ * half-cycle so the triac turns on as soon as the current rises.
+ * 
+ * The decision is spread over the cycles by accumulating the error, like
+ * Bresenham's line algorithm. It is taken once per full cycle so both halves
+ * match, a heater fed only the positive ones would draw DC.
  */
-void Triac::timeout()
+void Triac::nextHalfCycle()
 {
-    _triac.stopCounter();
+    burstSecondHalf = !burstSecondHalf;
 
-    digitalWrite(TRIAC_PIN, HIGH);
-    delayMicroseconds(10);
-    digitalWrite(TRIAC_PIN, LOW);
+    if(!burstSecondHalf)
+    {
+        burstAcc += burstOn;
+        burstFire = burstAcc >= burstCycles;
+        if(burstFire)
+            burstAcc -= burstCycles;
+    }
+
+    hal::setGate(firing && burstFire);
 }
 
 /**
- * @brief ISR called when the counter finished counting.
- * It resets interrupt flags and call the proper interrupt method.
+ * @brief Interrupt called when the counter reached tickCount, when the gate is
+ * driven from software.
  */
-ISR(TCB2_INT_vect)
+void Triac::timeout()
 {
-  TCB2.INTFLAGS = TCB_CAPT_bm;
-  _triac.timeout();
-}
\ No newline at end of file
+    ScopedProbe probe(Profiler::FiringIsr);
+
+    digitalWrite(TRIAC_PIN, HIGH);
+    delayMicroseconds(GATE_PULSE_US);
+    digitalWrite(TRIAC_PIN, LOW);
+}
@@ -4,35 +4,63 @@
 #include "thermometer.h"
 #include "triac.h"
 #include "controller.h"
+#include "history.h"
+#include "power.h"
+#include "profiler.h"
 
 #include <Arduino.h>
 #include <Wire.h>
 #include <Adafruit_I2CDevice.h>
 #include <Adafruit_GFX.h>
 
+#if defined(BUFFER_LENGTH)
+#define WIRE_CHUNK (BUFFER_LENGTH - 1)
+#else
+#define WIRE_CHUNK 31
+#endif
+
 Ui _ui;
 
+const Ui::Screen Ui::loadingScreen     = {&Ui::drawLoadingScreen,     0};
+const Ui::Screen Ui::idleScreen        = {&Ui::drawIdleScreen,        Ui::DependsOnTemperature |
+                                                                      Ui::DependsOnPower       |
+                                                                      Ui::DependsOnCountdown   |
+                                                                      Ui::DependsOnSettings};
+const Ui::Screen Ui::menuScreen        = {&Ui::drawMenuScreen,        Ui::DependsOnState};
+const Ui::Screen Ui::setTempScreen     = {&Ui::drawSetTempScreen,     Ui::DependsOnSettings};
+const Ui::Screen Ui::setTempBiasScreen = {&Ui::drawSetTempBiasScreen, Ui::DependsOnSettings};
+const Ui::Screen Ui::setAggregateScreen = {&Ui::drawSetAggregateScreen, Ui::DependsOnSettings};
+const Ui::Screen Ui::setWeightScreen   = {&Ui::drawSetWeightScreen,   Ui::DependsOnSettings};
+const Ui::Screen Ui::setTimeScreen     = {&Ui::drawSetTimeScreen,     Ui::DependsOnSettings};
+const Ui::Screen Ui::setModeScreen     = {&Ui::drawSetModeScreen,     Ui::DependsOnSettings};
+const Ui::Screen Ui::setSensorScreen   = {&Ui::drawSetSensorScreen,   Ui::DependsOnSettings};
+const Ui::Screen Ui::setFilterScreen   = {&Ui::drawSetFilterScreen,   Ui::DependsOnSettings};
+const Ui::Screen Ui::autotuneScreen    = {&Ui::drawAutotuneScreen,    Ui::DependsOnTemperature |
+                                                                      Ui::DependsOnPower       |
+                                                                      Ui::DependsOnAutotune};
+const Ui::Screen Ui::historyScreen     = {&Ui::drawHistoryScreen,     Ui::DependsOnHistory};
+const Ui::Screen Ui::debugScreen       = {&Ui::drawDebugScreen,       Ui::DependsOnTick};
+
 /**
  * @brief Initialise the display
+ * 
+ * The bus is left at 400kHz after each transaction since flush() talks to the
+ * screen directly.
  */
 Ui::Ui() :
-    display(SSD1306_LCDWIDTH, SSD1306_LCDHEIGHT, &Wire, -1)
+    display(SSD1306_LCDWIDTH, SSD1306_LCDHEIGHT, &Wire, -1, 400000UL, 400000UL)
 {}
 
 /**
- * @brief Setup the display and the buttons
+ * @brief Setup the display
  */
 void Ui::setup()
 {
-    display.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+    display.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDR);
     display.cp437();
     display.setTextColor(SSD1306_WHITE);
 
-    pinMode(SW1_PIN, INPUT_PULLUP);
-    pinMode(SW2_PIN, INPUT_PULLUP);
-    pinMode(SW3_PIN, INPUT_PULLUP);
-
-    setupInterrupt();
+    setMaxFps(UI_MAX_FPS);
 }
 
 /**
@@ -43,7 +71,7 @@ void Ui::turnOff()
     if(isTurnedOn)
     {
         display.clearDisplay();
-        display.display();
+        flush();
         display.ssd1306_command(SSD1306_DISPLAYOFF);
         isTurnedOn = false;
     }
@@ -51,6 +79,8 @@ void Ui::turnOff()
 
 /**
  * @brief Turn the backlight on again
+ * 
+ * The whole screen is sent again, whatever the shadow copy says.
  */
 void Ui::turnOn()
 {
@@ -58,11 +88,136 @@ void Ui::turnOn()
     {
         display.ssd1306_command(SSD1306_DISPLAYON);
         display.clearDisplay();
-        display.display();
+        _fullRefresh = true;
+        flush();
+        invalidate();
         isTurnedOn = true;
     }
 }
 
+/*******************************************************************************
+ * Render scheduling functions
+ ******************************************************************************/
+
+/**
+ * @brief Sets the maximum number of redraws per second
+ */
+void Ui::setMaxFps(uint8_t fps)
+{
+    frameTimer.setDeadline(1000 / (fps ? fps : 1));
+}
+
+/**
+ * @brief Forces the next render() to draw, whatever changed
+ */
+void Ui::invalidate()
+{
+    _screen = nullptr;
+}
+
+/**
+ * @brief Draws @a screen if it needs to.
+ * 
+ * A screen is redrawn when it has just been selected or when one of the model
+ * values it depends on changed, but never more than the max FPS allows.
+ * Screens depending on the tick are redrawn each time a frame is allowed.
+ */
+void Ui::render(const Screen& screen)
+{
+    if(!frameTimer.hasExpired())
+    {
+        skippedCount++;
+        return;
+    }
+
+    Model model;
+    snapshot(model);
+
+    if(&screen == _screen &&
+       !(screen.dependencies & DependsOnTick) &&
+       !hasChanged(model, screen.dependencies))
+    {
+        skippedCount++;
+        return;
+    }
+
+    frameTimer.restart();
+    _screen = &screen;
+    _model  = model;
+
+    (this->*screen.draw)();
+    redrawCount++;
+}
+
+/**
+ * @brief Reads the values displayed on screen into @a model
+ */
+void Ui::snapshot(Model& model) const
+{
+    model.state       = _controller.state;
+    model.temperature = utils::toTenths(_thermo.temperature);
+    model.triacPower  = _triac.power;
+    model.power       = _controller.powerState;
+    model.countdown   = _controller.thermoTimer.remainingTime() / 1000;
+    model.ideal       = _controller.ideal;
+    model.idealTmp    = _controller.idealTmp;
+    model.timerTmp    = _controller.timerTmp;
+    model.modeTmp     = _controller.modeTmp;
+    model.sensorTmp   = _controller.sensorTmp;
+    model.filterTmp   = _controller.filterTmp;
+    model.biasTmp     = _controller.biasTmp;
+    model.aggregateTmp = _controller.aggregateTmp;
+    model.weightTmp   = _controller.weightTmp;
+    model.sensorIndex = _controller.sensorIndex;
+    model.autotune    = _controller.autotune.status;
+    model.cycles      = _controller.autotune.cycles;
+    model.elapsed     = _controller.autotune.isRunning() ?
+                        _controller.autotune.timer.elapsedTime() / 1000 : 0;
+    model.history     = _history.revision;
+}
+
+/**
+ * @brief Whether one of the @a dependencies differs between @a model and the
+ * last drawn one.
+ */
+bool Ui::hasChanged(const Model& model, uint8_t dependencies) const
+{
+    if((dependencies & DependsOnState) && model.state != _model.state)
+        return true;
+
+    if((dependencies & DependsOnTemperature) && model.temperature != _model.temperature)
+        return true;
+
+    if((dependencies & DependsOnPower) && (model.triacPower != _model.triacPower ||
+                                           model.power      != _model.power))
+        return true;
+
+    if((dependencies & DependsOnCountdown) && model.countdown != _model.countdown)
+        return true;
+
+    if((dependencies & DependsOnSettings) && (model.ideal    != _model.ideal    ||
+                                              model.idealTmp != _model.idealTmp ||
+                                              model.timerTmp != _model.timerTmp ||
+                                              model.modeTmp  != _model.modeTmp  ||
+                                              model.sensorTmp != _model.sensorTmp ||
+                                              model.filterTmp != _model.filterTmp ||
+                                              model.biasTmp  != _model.biasTmp  ||
+                                              model.aggregateTmp != _model.aggregateTmp ||
+                                              model.weightTmp    != _model.weightTmp    ||
+                                              model.sensorIndex  != _model.sensorIndex))
+        return true;
+
+    if((dependencies & DependsOnAutotune) && (model.autotune != _model.autotune ||
+                                              model.cycles   != _model.cycles   ||
+                                              model.elapsed  != _model.elapsed))
+        return true;
+
+    if((dependencies & DependsOnHistory) && model.history != _model.history)
+        return true;
+
+    return false;
+}
+
 /*******************************************************************************
  * Drawing functions
  ******************************************************************************/
@@ -81,7 +236,7 @@ void Ui::drawLoadingScreen()
     display.setCursor(32, 18);
     display.print(F("  - Loading -  "));
 
-    display.display();
+    flush();
 }
 
 void Ui::drawIdleScreen()
@@ -106,15 +261,15 @@ void Ui::drawIdleScreen()
 
     display.setCursor(4, display.getCursorY());
     display.print("T: ");
-    display.print(_controller.ideal);
+    utils::printTenths(display, _controller.ideal);
     display.println(".C");
 
     display.setCursor(4, display.getCursorY());
     display.print("P: ");
 
-    if(_controller.isTurnedOn)
+    if(_controller.powerState == Controller::PowerOn)
     {
-        display.print(100 - ((_triac.triacDelay*100)/_triac.triacMax));
+        display.print((_triac.power + POWER_MAX/200) / (POWER_MAX/100));
         display.print("% ");
 
         if(_controller.shouldWarmUp())
@@ -122,6 +277,8 @@ void Ui::drawIdleScreen()
         else if(_controller.shouldCoolDown())
             display.write(25);
     }
+    else if(_controller.isTurnedOn)
+        display.print("start");
     else
         display.print("0% x");
     
@@ -129,10 +286,10 @@ void Ui::drawIdleScreen()
 
     display.setCursor(85, 9);
     display.setTextSize(1, 2);
-    display.print(_thermo.temperature, 1);
+    utils::printTenths(display, utils::toTenths(_thermo.temperature));
     display.print(".C");
 
-    display.display();
+    flush();
 }
 
 void Ui::drawMenuScreen()
@@ -164,6 +321,26 @@ void Ui::drawMenuScreen()
         display.print("Reset Timer");
         break;
 
+    case Controller::MenuSetMode:
+        display.setCursor(34, 4);
+        display.print("Power Mode");
+        break;
+
+    case Controller::MenuSetSensor:
+        display.setCursor(28, 4);
+        display.print("Sensor Setup");
+        break;
+
+    case Controller::MenuAutotune:
+        display.setCursor(40, 4);
+        display.print("Autotune");
+        break;
+
+    case Controller::MenuHistory:
+        display.setCursor(43, 4);
+        display.print("History");
+        break;
+
     case Controller::MenuShowLoading:
         display.setCursor(30, 4);
         display.print("Splash screen");
@@ -187,7 +364,7 @@ void Ui::drawMenuScreen()
 
     drawButton(96, 22, '\x10');
 
-    display.display();
+    flush();
 }
 
 void Ui::drawSetTempScreen()
@@ -197,14 +374,14 @@ void Ui::drawSetTempScreen()
     display.drawRect(0, 0, 128, 32, SSD1306_WHITE);
 
     display.setTextSize(1, 2);
-    display.setCursor(51, 9);
-    display.print(_controller.idealTmp);
+    display.setCursor(45, 9);
+    utils::printTenths(display, _controller.idealTmp);
     display.print(".C");
 
     drawButton(16, 16, '-');
     drawButton(112, 16, '+');
 
-    display.display();
+    flush();
 }
 
 void Ui::drawSetTempBiasScreen()
@@ -213,15 +390,73 @@ void Ui::drawSetTempBiasScreen()
 
     display.drawRect(0, 0, 128, 32, SSD1306_WHITE);
 
+    drawSensorIndex();
+
     display.setTextSize(1, 2);
     display.setCursor(50, 9);
-    display.print(_controller.biasTmp, 1);
+    utils::printTenths(display, _controller.biasTmp);
     display.print(".C");
 
     drawButton(16, 16, '-');
     drawButton(112, 16, '+');
 
-    display.display();
+    flush();
+}
+
+void Ui::drawSetAggregateScreen()
+{
+    display.clearDisplay();
+
+    display.drawRect(0, 0, 128, 32, SSD1306_WHITE);
+
+    display.setTextSize(1, 2);
+    display.setCursor(43, 9);
+    switch(_controller.aggregateTmp)
+    {
+    default:
+    case Thermometer::Mean:     display.print("Mean");     break;
+    case Thermometer::Min:      display.print("Min");      break;
+    case Thermometer::Max:      display.print("Max");      break;
+    case Thermometer::Weighted: display.print("Weighted"); break;
+    }
+
+    drawButton(16, 16, '-');
+    drawButton(112, 16, '+');
+
+    flush();
+}
+
+void Ui::drawSetWeightScreen()
+{
+    display.clearDisplay();
+
+    display.drawRect(0, 0, 128, 32, SSD1306_WHITE);
+
+    drawSensorIndex();
+
+    display.setTextSize(1, 2);
+    display.setCursor(50, 9);
+    display.print('x');
+    display.print(_controller.weightTmp);
+
+    drawButton(16, 16, '-');
+    drawButton(112, 16, '+');
+
+    flush();
+}
+
+/**
+ * @brief Tells which sensor is being calibrated, when there are several.
+ */
+void Ui::drawSensorIndex()
+{
+    if(_thermo.sensorCount < 2)
+        return;
+
+    display.setTextSize(1);
+    display.setCursor(4, 4);
+    display.print('S');
+    display.print(_controller.sensorIndex + 1);
 }
 
 void Ui::drawSetTimeScreen()
@@ -238,17 +473,264 @@ void Ui::drawSetTimeScreen()
     drawButton(16, 16, '-');
     drawButton(112, 16, '+');
 
-    display.display();
+    flush();
+}
+
+void Ui::drawSetModeScreen()
+{
+    display.clearDisplay();
+
+    display.drawRect(0, 0, 128, 32, SSD1306_WHITE);
+
+    display.setTextSize(1, 2);
+    if(_controller.modeTmp)
+    {
+        display.setCursor(40, 9);
+        display.print("Burst ");
+        display.print(_controller.modeTmp);
+    }
+    else
+    {
+        display.setCursor(49, 9);
+        display.print("Phase");
+    }
+
+    drawButton(16, 16, '-');
+    drawButton(112, 16, '+');
+
+    flush();
+}
+
+void Ui::drawSetSensorScreen()
+{
+    display.clearDisplay();
+
+    display.drawRect(0, 0, 128, 32, SSD1306_WHITE);
+
+    display.setTextSize(1, 2);
+    display.setCursor(40, 9);
+    if(_controller.sensorTmp != THERMO_ADAPTIVE)
+    {
+        display.print(_controller.sensorTmp);
+        display.print(" bits");
+    }
+    else
+        display.print("Adaptive");
+
+    drawButton(16, 16, '-');
+    drawButton(112, 16, '+');
+
+    flush();
+}
+
+void Ui::drawSetFilterScreen()
+{
+    display.clearDisplay();
+
+    display.drawRect(0, 0, 128, 32, SSD1306_WHITE);
+
+    display.setTextSize(1);
+    display.setCursor(4, 4);
+    display.print("Filter");
+
+    display.setTextSize(1, 2);
+    display.setCursor(46, 9);
+    display.print(Filter::name(_controller.filterTmp));
+
+    drawButton(16, 16, '-');
+    drawButton(112, 16, '+');
+
+    flush();
+}
+
+void Ui::drawAutotuneScreen()
+{
+    const Autotune& autotune = _controller.autotune;
+
+    display.clearDisplay();
+
+    display.drawRect(0, 0, 128, 32, SSD1306_WHITE);
+
+    display.setTextSize(1);
+    display.setCursor(4, 4);
+
+    switch(autotune.status)
+    {
+    case Autotune::Running:
+    {
+        unsigned int m, s;
+        autotune.timer.elapsedTime(m, s);
+
+        display.print("Tuning ");
+        display.print(autotune.cycles);
+        display.print('/');
+        display.print(AUTOTUNE_CYCLES);
+        display.print(' ');
+        if(m < 10) display.print('0');
+        display.print(m);
+        display.print(':');
+        if(s < 10) display.print('0');
+        display.println(s);
+
+        display.setCursor(4, display.getCursorY());
+        display.print("T: ");
+        utils::printTenths(display, utils::toTenths(_thermo.temperature));
+        display.print(".C ");
+        display.write(autotune.output > 0 ? 24 : 25);
+        break;
+    }
+
+    case Autotune::Done:
+        display.println("Tuning done");
+
+        display.setCursor(4, display.getCursorY());
+        display.print("P");
+        display.print(autotune.kp, 0);
+        display.print(" I");
+        display.print(autotune.ki, 1);
+        display.print(" D");
+        display.print(autotune.kd, 0);
+        break;
+
+    default:
+        display.println("Tuning failed");
+        break;
+    }
+
+    flush();
+}
+
+/**
+ * @brief Draws the history as a sparkline, the newest entry on the right.
+ * 
+ * Each column spans from the lowest to the highest temperature of its entry,
+ * the dotted line is the setpoint and the bars at the bottom are the power.
+ * The scale fits what is recorded, 1C at least. On the left are the top and
+ * bottom of the scale and how long each column lasts.
+ */
+void Ui::drawHistoryScreen()
+{
+    const uint8_t left   = SSD1306_LCDWIDTH - HISTORY_LEN;
+    const uint8_t bottom = 25; /**< Of the temperatures, the power is below */
+
+    display.clearDisplay();
+    display.setTextSize(1);
+
+    display.setCursor(0, 9);
+    if(_history.period < 60)
+    {
+        display.print(_history.period);
+        display.print('s');
+    }
+    else
+    {
+        display.print(_history.period / 60);
+        display.print('m');
+    }
+
+    uint8_t n = _history.size();
+    if(!n)
+    {
+        display.setCursor(left, 4);
+        display.print("Recording");
+        display.setCursor(left, 18);
+        display.print(History::bytes);
+        display.print(" bytes");
+
+        flush();
+        return;
+    }
+
+    int16_t lo = INT16_MAX;
+    int16_t hi = INT16_MIN;
+    for(uint8_t i = 0; i < n; i++)
+    {
+        const History::Entry& e = _history.at(i);
+        int16_t sp = utils::fromTenths(e.setpoint * 5);
+
+        lo = min(lo, min(e.min, sp));
+        hi = max(hi, max(e.max, sp));
+    }
+
+    if(hi - lo < TEMP_ONE)
+    {
+        int16_t mid = (hi + lo) / 2;
+        lo = mid - TEMP_ONE/2;
+        hi = mid + TEMP_ONE/2;
+    }
+
+    auto y = [=](int16_t t) -> uint8_t
+    {
+        return bottom - (int32_t)(t - lo) * bottom / (hi - lo);
+    };
+
+    for(uint8_t i = 0; i < n; i++)
+    {
+        const History::Entry& e = _history.at(i);
+        uint8_t x = left + HISTORY_LEN - n + i;
+
+        uint8_t top = y(e.max);
+        display.drawFastVLine(x, top, y(e.min) - top + 1, SSD1306_WHITE);
+
+        if(x % 2)
+            display.drawPixel(x, y(utils::fromTenths(e.setpoint * 5)), SSD1306_INVERSE);
+
+        uint8_t h = (e.power * 5 + 50) / 100;
+        if(h)
+            display.drawFastVLine(x, SSD1306_LCDHEIGHT - h, h, SSD1306_WHITE);
+    }
+
+    display.setCursor(0, 0);
+    utils::printTenths(display, utils::toTenths(hi));
+    display.setCursor(0, 18);
+    utils::printTenths(display, utils::toTenths(lo));
+
+    flush();
 }
 
 void Ui::drawDebugScreen()
 {
+    if(_controller.debugPage >= Controller::DebugTasks)
+    {
+        drawTaskPage(_controller.debugPage - Controller::DebugTasks);
+        return;
+    }
+
+    if(_controller.debugPage == Controller::DebugSleep)
+    {
+        drawSleepPage();
+        return;
+    }
+
+    if(_controller.debugPage == Controller::DebugSensors)
+    {
+        drawSensorsPage();
+        return;
+    }
+
+    if(_controller.debugPage == Controller::DebugFiring)
+    {
+        drawFiringPage();
+        return;
+    }
+
+    if(_controller.debugPage >= Controller::DebugProbes)
+    {
+        drawProbePage(_controller.debugPage - Controller::DebugProbes);
+        return;
+    }
+
     display.clearDisplay();
     display.setCursor(0, 0);
     display.setTextSize(1);
 
     display.print("T: ");
-    display.println(_thermo.temperature);
+    utils::printTenths(display, utils::toTenths(_thermo.temperature));
+    display.print(" ");
+    if(_thermo.trend.slope >= 0)
+        display.print('+');
+    utils::printTenths(display, utils::toTenths(_thermo.trend.slope));
+    display.println("/min");
 
     display.print("I: ");
     display.print(_triac.syncDelay);
@@ -257,11 +739,106 @@ void Ui::drawDebugScreen()
     display.print("|");
     display.println(_triac.tickCount);
 
+    display.print("M: ");
+    if(_triac.pll.locked)
+    {
+        display.print(_triac.pll.frequency());
+        display.print("Hz ");
+        display.print(_triac.pll.halfPeriod());
+    }
+    else
+        display.print("--");
+    display.print("|");
+    display.println(_triac.pll.glitches);
+
     display.print("L: ");
-    display.println(loopTimer.elapsedTime());
-    loopTimer.restart();
+    display.print(loopTime);
+    display.print(" R: ");
+    display.print(redrawCount);
+    display.print("|");
+    display.println(skippedCount);
 
-    display.display();
+    flush();
+}
+
+/**
+ * @brief Draws the durations recorded for @a stage: count, min|mean|max in
+ * microseconds and the log2 histogram, one 8px wide bar per bucket.
+ */
+void Ui::drawProbePage(uint8_t stage)
+{
+    Probe probe;
+    _profiler.snapshot(stage, probe);
+
+    display.clearDisplay();
+    display.setCursor(0, 0);
+    display.setTextSize(1);
+
+    display.print(Profiler::name(stage));
+    display.print(" n:");
+    display.println(probe.count);
+
+    display.print(probe.count ? probe.min : 0);
+    display.print("|");
+    display.print(probe.mean());
+    display.print("|");
+    display.print(probe.max);
+    display.println("us");
+
+    uint16_t top = 0;
+    for(uint8_t i = 0; i < PROBE_BUCKETS; i++)
+        if(probe.buckets[i] > top)
+            top = probe.buckets[i];
+
+    for(uint8_t i = 0; i < PROBE_BUCKETS && top; i++)
+    {
+        if(!probe.buckets[i])
+            continue;
+
+        uint8_t h = 1 + (uint32_t)(probe.buckets[i] - 1) * 15 / top;
+        display.fillRect(i * 8, 32 - h, 7, h, SSD1306_WHITE);
+    }
+
+    flush();
+}
+
+/**
+ * @brief Draws how the triac is fired, what the firing interrupt costs and
+ * how late after the zero crossing edge the delay starts being counted.
+ * 
+ * In hardware gate mode there is no firing interrupt at all, so the saving is
+ * the whole software figure. The spread of the latency (min|max) is the
+ * firing jitter the start mode adds.
+ */
+void Ui::drawFiringPage()
+{
+    Probe isr;
+    Probe latency;
+    _profiler.snapshot(Profiler::FiringIsr, isr);
+    _profiler.snapshot(Profiler::FiringLatency, latency);
+
+    display.clearDisplay();
+    display.setCursor(0, 0);
+    display.setTextSize(1);
+
+    display.print(_triac.hardwareGate ? "Gate:hw" : "Gate:sw");
+    display.println(_triac.edgeStart ? " Start:evt" : " Start:irq");
+
+    display.print("Isr: ");
+    display.print(isr.mean());
+    display.print("|");
+    display.print(isr.max);
+    display.println("us");
+
+    display.print("Lat: ");
+    display.print(latency.count ? latency.min : 0);
+    display.print("|");
+    display.print(latency.max);
+    display.println("us");
+
+    display.println("c: switch");
+
+    flush();
 }
 
 void Ui::drawButton(int x, int y, char c)
@@ -273,57 +850,214 @@ void Ui::drawButton(int x, int y, char c)
 }
 
 /*******************************************************************************
- * Buttons management function
+ * Screen transfer functions
  ******************************************************************************/
-bool Ui::hasButtonBeenPressed() const
-{
-    return btnLeftPressed || btnCenterPressed || btnRightPressed;
-}
 
-void Ui::resetButtons()
+/**
+ * @brief Sends the frame buffer to the screen.
+ * 
+ * Sending the whole 512 bytes buffer takes ~12ms at 400kHz, even when only one
+ * digit changed. So we keep a shadow copy of what the screen displays, compare
+ * it page by page and only send the column spans that differ. Close spans are
+ * merged since a new span costs its addressing commands.
+ */
+void Ui::flush()
 {
-    btnLeftPressed = false;
-    btnRightPressed = false;
-    btnCenterPressed = false;
-}
+    const uint8_t* buffer = display.getBuffer();
 
-void Ui::setupInterrupt()
-{
-    attachInterrupt(digitalPinToInterrupt(SW1_PIN), Ui::interrupt1, FALLING);
-    attachInterrupt(digitalPinToInterrupt(SW2_PIN), Ui::interrupt2, FALLING);
-    attachInterrupt(digitalPinToInterrupt(SW3_PIN), Ui::interrupt3, FALLING);
-}
+    if(_fullRefresh)
+    {
+        for(uint8_t page = 0; page < SCREEN_PAGES; page++)
+            sendSpan(page, 0, SSD1306_LCDWIDTH - 1);
 
-void Ui::removeInterrupt()
-{
-    detachInterrupt(digitalPinToInterrupt(SW1_PIN));
-    detachInterrupt(digitalPinToInterrupt(SW2_PIN));
-    detachInterrupt(digitalPinToInterrupt(SW3_PIN));
+        memcpy(_shadow, buffer, sizeof(_shadow));
+        _fullRefresh = false;
+        return;
+    }
+
+    for(uint8_t page = 0; page < SCREEN_PAGES; page++)
+    {
+        const uint8_t* row    = buffer  + page * SSD1306_LCDWIDTH;
+        uint8_t*       shadow = _shadow + page * SSD1306_LCDWIDTH;
+
+        uint8_t x = 0;
+        while(x < SSD1306_LCDWIDTH)
+        {
+            // Skip what is already on screen
+            while(x < SSD1306_LCDWIDTH && row[x] == shadow[x])
+                x++;
+
+            if(x == SSD1306_LCDWIDTH)
+                break;
+
+            // Extend the span until too many columns are unchanged
+            uint8_t start = x;
+            uint8_t end   = x;
+            uint8_t clean = 0;
+            for(; x < SSD1306_LCDWIDTH && clean <= SPAN_GAP; x++)
+            {
+                if(row[x] != shadow[x])
+                {
+                    end = x;
+                    clean = 0;
+                }
+                else
+                    clean++;
+            }
+
+            sendSpan(page, start, end);
+            memcpy(shadow + start, row + start, end - start + 1);
+        }
+    }
 }
 
-void Ui::interrupt(volatile bool& btn)
+/**
+ * @brief Sends the columns @a start to @a end (included) of @a page.
+ * 
+ * It sets the addressing window of the controller, then streams the data in
+ * chunks that fit the Wire buffer.
+ */
+void Ui::sendSpan(uint8_t page, uint8_t start, uint8_t end)
 {
-    static unsigned long last_time = 0;
-    unsigned long time = millis();
+    Wire.beginTransmission(SCREEN_ADDR);
+    Wire.write((uint8_t)0x00); // Command stream
+    Wire.write(SSD1306_COLUMNADDR);
+    Wire.write(start);
+    Wire.write(end);
+    Wire.write(SSD1306_PAGEADDR);
+    Wire.write(page);
+    Wire.write(page);
+    Wire.endTransmission();
+
+    const uint8_t* data = display.getBuffer() + page * SSD1306_LCDWIDTH + start;
+    uint8_t count = end - start + 1;
+
+    while(count)
+    {
+        uint8_t n = count < WIRE_CHUNK ? count : WIRE_CHUNK;
 
-    // If interrupts come faster than 300ms, assume it's a bounce and ignore
-    if (time - last_time > 300)
-        btn = true;
+        Wire.beginTransmission(SCREEN_ADDR);
+        Wire.write((uint8_t)0x40); // Data stream
+        Wire.write(data, n);
+        Wire.endTransmission();
 
-    last_time = time;
+        data  += n;
+        count -= n;
+    }
 }
 
-void Ui::interrupt1()
+/**
+ * @brief Draws how long the CPU slept and was awake since boot, and how many
+ * times it went to sleep.
+ */
+void Ui::drawSleepPage()
 {
-    interrupt(_ui.btnLeftPressed);
+    unsigned long total = _scheduler.asleep + _scheduler.awake;
+
+    display.clearDisplay();
+    display.setCursor(0, 0);
+    display.setTextSize(1);
+
+    display.print("Sleep ");
+    utils::printFixed(display, total ? (uint64_t)_scheduler.asleep * 1000 / total : 0, 1);
+    display.println("%");
+
+    display.print("Asleep: ");
+    display.print(_scheduler.asleep / 1000);
+    display.println("s");
+
+    display.print("Awake: ");
+    display.print(_scheduler.awake / 1000);
+    display.println("s");
+
+    display.print("Sleeps: ");
+    display.println(_scheduler.idles);
+
+    flush();
 }
 
-void Ui::interrupt2()
+/**
+ * @brief Draws how the task @a i keeps up: its period, runs, overruns of its
+ * budget, longest run and the most it started late.
+ */
+void Ui::drawTaskPage(uint8_t i)
 {
-    interrupt(_ui.btnCenterPressed);
+    const Task& t = _controller.tasks[i];
+
+    display.clearDisplay();
+    display.setCursor(0, 0);
+    display.setTextSize(1);
+
+    display.print(t.name);
+    display.print(" ");
+    display.print(t.period);
+    display.print("ms");
+    if(i == Controller::InputTask)
+    {
+        // Button edges that did not fit in the queue
+        display.print(" Lost: ");
+        display.print(_buttons.overflows);
+    }
+    display.println();
+
+    display.print("n: ");
+    display.println(t.runs);
+
+    display.print("Over: ");
+    display.print(t.overruns);
+    display.print(" Late: ");
+    display.print(t.late);
+    display.println("ms");
+
+    display.print("Max: ");
+    display.print(t.longest);
+    display.print("|");
+    display.print(t.budget);
+    display.println("us");
+
+    flush();
 }
 
-void Ui::interrupt3()
+/**
+ * @brief Draws how the temperature is read: the sensors answering, the
+ * resolution and sample period, the reading before and after the filter, its
+ * slope and each sensor reading.
+ */
+void Ui::drawSensorsPage()
 {
-    interrupt(_ui.btnRightPressed);
-}
\ No newline at end of file
+    display.clearDisplay();
+    display.setCursor(0, 0);
+    display.setTextSize(1);
+
+    display.print("Sensors ");
+    display.print(_thermo.presentCount());
+    display.print("/");
+    display.print(_thermo.sensorCount);
+    display.print(" ");
+    display.print(_thermo.bits());
+    display.print("b|");
+    display.print(_thermo.samplePeriod);
+    display.println("ms");
+
+    utils::printFixed(display, utils::toHundredths(_thermo.raw), 2);
+    display.print(" > ");
+    utils::printFixed(display, utils::toHundredths(_thermo.temperature), 2);
+    display.print(" ");
+    display.println(Filter::name(_thermo.filter.mode));
+
+    if(_thermo.trend.slope >= 0)
+        display.print('+');
+    utils::printFixed(display, utils::toHundredths(_thermo.trend.slope), 2);
+    display.println("C/min");
+
+    for(uint8_t i = 0; i < _thermo.sensorCount; i++)
+    {
+        if(_thermo.sensors[i].present)
+            utils::printTenths(display, utils::toTenths(_thermo.sensors[i].temperature));
+        else
+            display.print("--");
+        display.print(" ");
+    }
+
+    flush();
+}
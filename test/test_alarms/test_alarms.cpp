@@ -0,0 +1,173 @@
+#include <unity.h>
+
+#include "alarms.h"
+#include "sim.h"
+
+static char    fired[8];
+static uint8_t firedCount = 0;
+
+static void fireA() { fired[firedCount++] = 'a'; }
+static void fireB() { fired[firedCount++] = 'b'; }
+static void fireC() { fired[firedCount++] = 'c'; }
+
+static Alarm a(fireA);
+static Alarm b(fireB);
+static Alarm c(fireC);
+
+void setUp()
+{
+    firedCount = 0;
+}
+
+void tearDown()
+{
+    _alarms.cancel(a);
+    _alarms.cancel(b);
+    _alarms.cancel(c);
+}
+
+/**
+ * @brief Moves the virtual clock @a ms forward and fires what is due
+ */
+static void wait(unsigned long ms)
+{
+    sim::advance(ms * 1000ULL);
+    _alarms.update();
+}
+
+/**
+ * @brief Moves the virtual clock to @a ms before the next millis() rollover
+ */
+static void waitRollover(unsigned long ms)
+{
+    uint64_t now  = sim::now() / 1000;
+    uint64_t wrap = ((now >> 32) + 1) << 32;
+    sim::advance((wrap - ms - now) * 1000ULL);
+}
+
+void test_fires_in_deadline_order()
+{
+    a.setDeadline(300);
+    b.setDeadline(100);
+    c.setDeadline(200);
+    a.restart();
+    b.restart();
+    c.restart();
+
+    wait(99);
+    TEST_ASSERT_EQUAL_UINT8(0, firedCount);
+    TEST_ASSERT_FALSE(b.hasExpired());
+
+    wait(250);
+    TEST_ASSERT_EQUAL_UINT8(3, firedCount);
+    TEST_ASSERT_EQUAL_MEMORY("bca", fired, 3);
+    TEST_ASSERT_TRUE(a.hasExpired());
+    TEST_ASSERT_EQUAL_UINT32(0, a.remainingTime());
+}
+
+void test_order_across_rollover()
+{
+    waitRollover(150);
+
+    a.setDeadline(300);
+    b.setDeadline(100);
+    a.restart();
+    b.restart();
+
+    // b is due before the rollover, a after
+    wait(120);
+    TEST_ASSERT_EQUAL_UINT8(1, firedCount);
+    TEST_ASSERT_EQUAL_CHAR('b', fired[0]);
+    TEST_ASSERT_FALSE(a.hasExpired());
+    TEST_ASSERT_UINT32_WITHIN(2, 180, a.remainingTime());
+
+    wait(100);
+    TEST_ASSERT_EQUAL_UINT8(1, firedCount);
+
+    wait(90);
+    TEST_ASSERT_EQUAL_UINT8(2, firedCount);
+    TEST_ASSERT_EQUAL_CHAR('a', fired[1]);
+}
+
+void test_inserted_across_rollover()
+{
+    // c starts before the rollover, b after it but is due first
+    waitRollover(50);
+    c.setDeadline(500);
+    c.restart();
+
+    wait(100);
+    b.setDeadline(100);
+    b.restart();
+
+    wait(150);
+    TEST_ASSERT_EQUAL_UINT8(1, firedCount);
+    TEST_ASSERT_EQUAL_CHAR('b', fired[0]);
+
+    wait(300);
+    TEST_ASSERT_EQUAL_UINT8(2, firedCount);
+    TEST_ASSERT_EQUAL_CHAR('c', fired[1]);
+}
+
+void test_stays_expired()
+{
+    a.setDeadline(10);
+    a.restart();
+    wait(20);
+    TEST_ASSERT_EQUAL_UINT8(1, firedCount);
+
+    // A whole millis() turn later, it is still over
+    sim::advance(0x100000000ULL * 1000);
+    _alarms.update();
+    TEST_ASSERT_TRUE(a.hasExpired());
+    TEST_ASSERT_EQUAL_UINT8(1, firedCount);
+}
+
+void test_set_deadline_moves_it()
+{
+    a.setDeadline(100);
+    a.restart();
+    b.setDeadline(200);
+    b.restart();
+
+    // Later than b now
+    a.setDeadline(300);
+    wait(250);
+    TEST_ASSERT_EQUAL_UINT8(1, firedCount);
+    TEST_ASSERT_EQUAL_CHAR('b', fired[0]);
+
+    // Already past, fires right away
+    a.setDeadline(100);
+    wait(0);
+    TEST_ASSERT_EQUAL_UINT8(2, firedCount);
+    TEST_ASSERT_EQUAL_CHAR('a', fired[1]);
+
+    // Longer than what elapsed since the restart, pending again
+    a.setDeadline(1000);
+    TEST_ASSERT_FALSE(a.hasExpired());
+    wait(800);
+    TEST_ASSERT_EQUAL_UINT8(3, firedCount);
+}
+
+void test_cancel()
+{
+    a.setDeadline(10);
+    a.restart();
+    _alarms.cancel(a);
+
+    wait(20);
+    TEST_ASSERT_EQUAL_UINT8(0, firedCount);
+    TEST_ASSERT_TRUE(a.hasExpired());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fires_in_deadline_order);
+    RUN_TEST(test_order_across_rollover);
+    RUN_TEST(test_inserted_across_rollover);
+    RUN_TEST(test_stays_expired);
+    RUN_TEST(test_set_deadline_moves_it);
+    RUN_TEST(test_cancel);
+    return UNITY_END();
+}
@@ -0,0 +1,97 @@
+#include <unity.h>
+
+#include <math.h>
+
+#include "pid.h"
+#include "power.h"
+
+static Pid pid;
+
+void setUp()
+{
+    pid = Pid();
+    pid.setLimits(0, POWER_MAX);
+    pid.reset(0);
+}
+
+void tearDown() {}
+
+void test_proportional()
+{
+    pid.setGains(100, 0, 0);
+    pid.compute(30, 30, 1);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 200, pid.compute(30, 28, 1));
+}
+
+void test_bumpless_transfer()
+{
+    pid.reset(4000);
+
+    // Far from the setpoint, the output still starts from where it was
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 4000, pid.compute(30, 27.5f, 0.25f));
+
+    // Then moves from there
+    float next = pid.compute(30, 27.5f, 0.25f);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 4000 + PID_KI * 2.5f * 0.25f, next);
+}
+
+void test_anti_windup()
+{
+    pid.setGains(1000, 50, 0);
+    pid.compute(50, 20, 1);
+
+    // Saturated for an hour
+    for(int i = 0; i < 3600; i++)
+        pid.compute(50, 20, 1);
+
+    TEST_ASSERT_EQUAL_FLOAT(POWER_MAX, pid.output);
+    TEST_ASSERT_TRUE(pid.integral <= POWER_MAX);
+
+    // Backs off as soon as the setpoint is passed, instead of unwinding an
+    // hour worth of integral
+    float out = pid.compute(50, 50.5f, 1);
+    TEST_ASSERT_TRUE(out < POWER_MAX);
+    TEST_ASSERT_FLOAT_WITHIN(30, POWER_MAX - 500, out);
+}
+
+void test_no_derivative_kick()
+{
+    pid.setGains(0, 0, 100);
+    pid.compute(30, 30, 1);
+    pid.compute(30, 30, 1);
+
+    // Only the measurement moves the derivative, not the setpoint
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0, pid.compute(60, 30, 1));
+}
+
+void test_output_clamped()
+{
+    pid.setGains(1000, 0, 0);
+    pid.compute(30, 30, 1);
+
+    TEST_ASSERT_EQUAL_FLOAT(POWER_MAX, pid.compute(60, 20, 1));
+    TEST_ASSERT_EQUAL_FLOAT(0, pid.compute(20, 60, 1));
+}
+
+void test_unusable_gains_fall_back()
+{
+    pid.setGains(NAN, -1, INFINITY);
+    pid.setup();
+
+    TEST_ASSERT_EQUAL_FLOAT(PID_KP, pid.kp);
+    TEST_ASSERT_EQUAL_FLOAT(PID_KI, pid.ki);
+    TEST_ASSERT_EQUAL_FLOAT(PID_KD, pid.kd);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_proportional);
+    RUN_TEST(test_bumpless_transfer);
+    RUN_TEST(test_anti_windup);
+    RUN_TEST(test_no_derivative_kick);
+    RUN_TEST(test_output_clamped);
+    RUN_TEST(test_unusable_gains_fall_back);
+    return UNITY_END();
+}
@@ -0,0 +1,69 @@
+#include <unity.h>
+
+#include <math.h>
+
+#include "power.h"
+
+void setUp() {}
+void tearDown() {}
+
+/**
+ * @brief Fraction of the full power delivered when firing at @a a (0..1) of
+ * the half-cycle, for a resistive load
+ */
+static double delivered(double a)
+{
+    return 1 - a + sin(2 * M_PI * a) / (2 * M_PI);
+}
+
+void test_ends_are_exact()
+{
+    TEST_ASSERT_EQUAL_UINT16(65535, power::toAngle(0));
+    TEST_ASSERT_EQUAL_UINT16(0, power::toAngle(POWER_MAX));
+    TEST_ASSERT_EQUAL_UINT16(0, power::toAngle(POWER_MAX + 1));
+}
+
+void test_more_power_fires_earlier()
+{
+    uint16_t last = power::toAngle(0);
+    for(unsigned int p = 1; p <= POWER_MAX; p++)
+    {
+        uint16_t angle = power::toAngle(p);
+        TEST_ASSERT_TRUE(angle <= last);
+        last = angle;
+    }
+}
+
+void test_half_power_is_half_way()
+{
+    // The curve is symmetric around the middle of the half-cycle
+    TEST_ASSERT_UINT16_WITHIN(2, 32768, power::toAngle(POWER_MAX / 2));
+}
+
+void test_delivers_what_is_asked()
+{
+    const unsigned int step = POWER_MAX / POWER_STEPS;
+
+    for(unsigned int p = 0; p <= POWER_MAX; p += 10)
+    {
+        float got = delivered(power::toAngle(p) / 65535.0) * POWER_MAX;
+
+        // Within 0.5% of full power, except in the first and last steps where
+        // the curve is too steep for a linear interpolation, there it stays
+        // within the step
+        if(p < step || p > POWER_MAX - step)
+            TEST_ASSERT_FLOAT_WITHIN(step, p, got);
+        else
+            TEST_ASSERT_FLOAT_WITHIN(50, p, got);
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_ends_are_exact);
+    RUN_TEST(test_more_power_fires_earlier);
+    RUN_TEST(test_half_power_is_half_way);
+    RUN_TEST(test_delivers_what_is_asked);
+    return UNITY_END();
+}
@@ -0,0 +1,160 @@
+#include <unity.h>
+
+#include <EEPROM.h>
+#include <stddef.h>
+
+#include "settings.h"
+#include "sim.h"
+
+static void erase()
+{
+    for(uint16_t i = 0; i < EEPROM.length(); i++)
+        EEPROM.update(i, 0xFF);
+}
+
+void setUp()
+{
+    erase();
+}
+
+void tearDown() {}
+
+/**
+ * @brief Writes a valid record with @a sequence and @a ideal in @a slot,
+ * broken if @a corrupt.
+ */
+static void putRecord(uint8_t slot, uint16_t sequence, int16_t ideal, bool corrupt = false)
+{
+    Settings::Record r;
+    memset(static_cast<void*>(&r), 0, sizeof(r));
+
+    r.version      = SETTINGS_VERSION;
+    r.sequence     = sequence;
+    r.config       = Config();
+    r.config.ideal = ideal;
+    r.crc          = Settings::crc(reinterpret_cast<const uint8_t*>(&r), offsetof(Settings::Record, crc));
+
+    if(corrupt)
+        r.config.ideal++;
+
+    EEPROM.put(slot * sizeof(Settings::Record), r);
+}
+
+/**
+ * @brief Writes whatever record @a s is committing, as the main loop would
+ */
+static void finishCommit(Settings& s)
+{
+    for(int i = 0; i < 1000 && s.isCommitting(); i++)
+    {
+        s.update();
+        sim::advance(1000);
+    }
+}
+
+void test_crc()
+{
+    // CRC-16/CCITT-FALSE check value
+    const char* check = "123456789";
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, Settings::crc(reinterpret_cast<const uint8_t*>(check), 9));
+    TEST_ASSERT_EQUAL_HEX16(0xFFFF, Settings::crc(nullptr, 0));
+}
+
+void test_newest_record_wins()
+{
+    putRecord(0, 7, 300);
+    putRecord(1, 8, 310);
+    putRecord(2, 6, 290);
+
+    Settings s;
+    s.load();
+
+    TEST_ASSERT_EQUAL_INT16(310, s.config.ideal);
+    TEST_ASSERT_EQUAL_UINT8(1, s.slot);
+    TEST_ASSERT_EQUAL_UINT16(8, s.sequence);
+}
+
+void test_sequence_wraps_around()
+{
+    putRecord(2, 0xFFFE, 300);
+    putRecord(3, 0xFFFF, 310);
+    putRecord(4, 0x0000, 320);
+    putRecord(5, 0x0001, 330);
+
+    Settings s;
+    s.load();
+
+    TEST_ASSERT_EQUAL_INT16(330, s.config.ideal);
+    TEST_ASSERT_EQUAL_UINT8(5, s.slot);
+}
+
+void test_corrupt_record_is_skipped()
+{
+    putRecord(0, 1, 300);
+    putRecord(1, 2, 310, true);
+
+    Settings s;
+    s.load();
+
+    TEST_ASSERT_EQUAL_INT16(300, s.config.ideal);
+    TEST_ASSERT_EQUAL_UINT8(0, s.slot);
+}
+
+void test_commit_goes_to_the_next_slot()
+{
+    const uint8_t last = Settings::slotCount() - 1;
+    putRecord(last, 41, 300);
+
+    Settings s;
+    s.load();
+    s.set(s.config.ideal, 355);
+    TEST_ASSERT_TRUE(s.dirty);
+
+    // Nothing is written before SETTINGS_QUIET
+    s.update();
+    TEST_ASSERT_FALSE(s.isCommitting());
+
+    s.quietTimer.setDeadline(0);
+    s.update();
+    TEST_ASSERT_TRUE(s.isCommitting());
+    finishCommit(s);
+
+    // Wrapped around to the first slot, read back as the newest
+    TEST_ASSERT_EQUAL_UINT8(0, s.slot);
+
+    Settings reloaded;
+    reloaded.load();
+    TEST_ASSERT_EQUAL_INT16(355, reloaded.config.ideal);
+    TEST_ASSERT_EQUAL_UINT8(0, reloaded.slot);
+    TEST_ASSERT_EQUAL_UINT16(42, reloaded.sequence);
+}
+
+void test_set_same_value_is_not_a_change()
+{
+    Settings s;
+    s.set(s.config.ideal, s.config.ideal);
+    TEST_ASSERT_FALSE(s.dirty);
+}
+
+void test_erased_eeprom_keeps_the_timer()
+{
+    Settings s;
+    s.load();
+
+    // Older versions never expired an erased timer
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFF, s.config.timer);
+    TEST_ASSERT_EQUAL_UINT8(Settings::slotCount() - 1, s.slot);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_crc);
+    RUN_TEST(test_newest_record_wins);
+    RUN_TEST(test_sequence_wraps_around);
+    RUN_TEST(test_corrupt_record_is_skipped);
+    RUN_TEST(test_commit_goes_to_the_next_slot);
+    RUN_TEST(test_set_same_value_is_not_a_change);
+    RUN_TEST(test_erased_eeprom_keeps_the_timer);
+    return UNITY_END();
+}
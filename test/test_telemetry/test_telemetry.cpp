@@ -0,0 +1,107 @@
+#include <unity.h>
+
+#include "telemetry.h"
+
+void setUp() {}
+void tearDown() {}
+
+/**
+ * @brief Decodes the COBS @a frame, delimiter included, into @a data. Returns
+ * its length, or -1 if the frame is malformed.
+ */
+static int decode(const uint8_t* frame, uint8_t len, uint8_t* data)
+{
+    int n = 0;
+    uint8_t i = 0;
+
+    while(i < len - 1)
+    {
+        uint8_t code = frame[i++];
+        if(!code)
+            return -1;
+
+        for(uint8_t j = 1; j < code; j++)
+        {
+            if(!frame[i])
+                return -1;
+            data[n++] = frame[i++];
+        }
+
+        if(code < 0xFF && i < len - 1)
+            data[n++] = 0;
+    }
+
+    return frame[len - 1] == 0 ? n : -1;
+}
+
+void test_empty()
+{
+    uint8_t frame[Telemetry::frameMax];
+    const uint8_t expected[] = {0x01, 0x00};
+
+    TEST_ASSERT_EQUAL_UINT8(2, Telemetry::encode(nullptr, 0, frame));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, frame, 2);
+}
+
+void test_single_zero()
+{
+    const uint8_t data[] = {0x00};
+    const uint8_t expected[] = {0x01, 0x01, 0x00};
+    uint8_t frame[Telemetry::frameMax];
+
+    TEST_ASSERT_EQUAL_UINT8(3, Telemetry::encode(data, 1, frame));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, frame, 3);
+}
+
+void test_zeros_in_the_middle()
+{
+    const uint8_t data[] = {0x11, 0x22, 0x00, 0x33};
+    const uint8_t expected[] = {0x03, 0x11, 0x22, 0x02, 0x33, 0x00};
+    uint8_t frame[Telemetry::frameMax];
+
+    TEST_ASSERT_EQUAL_UINT8(6, Telemetry::encode(data, 4, frame));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, frame, 6);
+}
+
+void test_only_the_delimiter_is_zero()
+{
+    uint8_t data[TELEMETRY_PAYLOAD];
+    for(uint8_t i = 0; i < TELEMETRY_PAYLOAD; i++)
+        data[i] = i % 3 ? i : 0;
+
+    uint8_t frame[Telemetry::frameMax];
+    uint8_t n = Telemetry::encode(data, TELEMETRY_PAYLOAD, frame);
+
+    TEST_ASSERT_TRUE(n <= Telemetry::frameMax);
+    for(uint8_t i = 0; i < n - 1; i++)
+        TEST_ASSERT_NOT_EQUAL(0, frame[i]);
+    TEST_ASSERT_EQUAL_UINT8(0, frame[n - 1]);
+}
+
+void test_round_trip()
+{
+    Telemetry::Sample s = {};
+    s.type        = TELEMETRY_SAMPLE;
+    s.sequence    = 0x0100;
+    s.temperature = 30 * 128;
+    s.power       = 0;
+    s.loopMax     = 0xFF00;
+
+    uint8_t frame[Telemetry::frameMax];
+    uint8_t n = Telemetry::encode(reinterpret_cast<const uint8_t*>(&s), sizeof(s), frame);
+
+    uint8_t data[Telemetry::frameMax];
+    TEST_ASSERT_EQUAL_INT(sizeof(s), decode(frame, n, data));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(reinterpret_cast<const uint8_t*>(&s), data, sizeof(s));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_empty);
+    RUN_TEST(test_single_zero);
+    RUN_TEST(test_zeros_in_the_middle);
+    RUN_TEST(test_only_the_delimiter_is_zero);
+    RUN_TEST(test_round_trip);
+    return UNITY_END();
+}
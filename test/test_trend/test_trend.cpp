@@ -0,0 +1,75 @@
+#include <unity.h>
+
+#include "filter.h"
+#include "utils.h"
+
+static Trend trend;
+
+void setUp()
+{
+    trend.reset();
+}
+
+void tearDown() {}
+
+void test_needs_three_samples()
+{
+    trend.update(0, 0);
+    trend.update(100, 1000);
+    TEST_ASSERT_EQUAL_INT16(0, trend.slope);
+
+    trend.update(200, 2000);
+    TEST_ASSERT_EQUAL_INT16(100 * 60, trend.slope);
+}
+
+void test_ramp()
+{
+    // 1/8 C per second is 7.5 C per minute
+    for(int i = 0; i < 3 * TREND_N; i++)
+    {
+        trend.update(20 * TEMP_ONE + i * TEMP_ONE / 8, 5000 + i * 1000UL);
+        if(i >= 2)
+            TEST_ASSERT_EQUAL_INT16(TEMP_ONE * 15 / 2, trend.slope);
+    }
+}
+
+void test_falling()
+{
+    for(int i = 0; i < 2 * TREND_N; i++)
+        trend.update(60 * TEMP_ONE - i * TEMP_ONE / 4, i * 2000UL);
+
+    // 1/4 C every 2 seconds
+    TEST_ASSERT_EQUAL_INT16(-TEMP_ONE * 15 / 2, trend.slope);
+}
+
+void test_samples_too_close_are_ignored()
+{
+    for(int i = 0; i < TREND_N; i++)
+    {
+        trend.update(i * 10, i * 1000UL);
+
+        // A glitch between two slots does not count
+        trend.update(5000, i * 1000UL + 500);
+    }
+
+    TEST_ASSERT_EQUAL_INT16(600, trend.slope);
+}
+
+void test_steady()
+{
+    for(int i = 0; i < 2 * TREND_N; i++)
+        trend.update(30 * TEMP_ONE + (i % 2), i * 1000UL);
+
+    TEST_ASSERT_INT16_WITHIN(2, 0, trend.slope);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_needs_three_samples);
+    RUN_TEST(test_ramp);
+    RUN_TEST(test_falling);
+    RUN_TEST(test_samples_too_close_are_ignored);
+    RUN_TEST(test_steady);
+    return UNITY_END();
+}
@@ -0,0 +1,123 @@
+#include <unity.h>
+
+#include "utils.h"
+
+void setUp() {}
+void tearDown() {}
+
+/**
+ * @brief Keeps what is printed in a string
+ */
+class StringPrint : public Print
+{
+public:
+    size_t write(uint8_t c) override
+    {
+        if(_n < sizeof(text) - 1)
+        {
+            text[_n++] = c;
+            text[_n]   = 0;
+        }
+        return 1;
+    }
+
+    char text[32] = {0};
+
+private:
+    size_t _n = 0;
+};
+
+static void assertPrinted(const char* expected, long v, uint8_t decimals)
+{
+    StringPrint out;
+    utils::printFixed(out, v, decimals);
+    TEST_ASSERT_EQUAL_STRING(expected, out.text);
+}
+
+void test_print_fixed()
+{
+    assertPrinted("1.25",  125, 2);
+    assertPrinted("-1.25", -125, 2);
+    assertPrinted("0.5",   5, 1);
+    assertPrinted("-0.5",  -5, 1);
+    assertPrinted("100.00", 10000, 2);
+    assertPrinted("0.07",  7, 2);
+}
+
+void test_print_tenths()
+{
+    StringPrint out;
+    utils::printTenths(out, 305);
+    TEST_ASSERT_EQUAL_STRING("30.5", out.text);
+}
+
+void test_parse_fixed()
+{
+    long v = 0;
+
+    TEST_ASSERT_TRUE(utils::parseFixed("-1.25", 2, v));
+    TEST_ASSERT_EQUAL_INT32(-125, v);
+
+    TEST_ASSERT_TRUE(utils::parseFixed("+3", 2, v));
+    TEST_ASSERT_EQUAL_INT32(300, v);
+
+    TEST_ASSERT_TRUE(utils::parseFixed("35.", 1, v));
+    TEST_ASSERT_EQUAL_INT32(350, v);
+
+    TEST_ASSERT_TRUE(utils::parseFixed(".5", 1, v));
+    TEST_ASSERT_EQUAL_INT32(5, v);
+
+    // Decimals beyond the ones asked for are ignored, not rounded
+    TEST_ASSERT_TRUE(utils::parseFixed("1.239", 2, v));
+    TEST_ASSERT_EQUAL_INT32(123, v);
+}
+
+void test_parse_fixed_rejects()
+{
+    long v = 42;
+
+    TEST_ASSERT_FALSE(utils::parseFixed("", 1, v));
+    TEST_ASSERT_FALSE(utils::parseFixed("-", 1, v));
+    TEST_ASSERT_FALSE(utils::parseFixed(".", 1, v));
+    TEST_ASSERT_FALSE(utils::parseFixed("1.2.3", 1, v));
+    TEST_ASSERT_FALSE(utils::parseFixed("12a", 1, v));
+    TEST_ASSERT_FALSE(utils::parseFixed("999999999999", 1, v));
+
+    // Left alone when rejected
+    TEST_ASSERT_EQUAL_INT32(42, v);
+}
+
+void test_round_trip()
+{
+    for(long v = -2000; v <= 2000; v += 7)
+    {
+        StringPrint out;
+        utils::printFixed(out, v, 2);
+
+        long parsed = 0;
+        TEST_ASSERT_TRUE(utils::parseFixed(out.text, 2, parsed));
+        TEST_ASSERT_EQUAL_INT32(v, parsed);
+    }
+}
+
+void test_tenths_conversions()
+{
+    TEST_ASSERT_EQUAL_INT16(30 * TEMP_ONE, utils::fromTenths(300));
+    TEST_ASSERT_EQUAL_INT(300, utils::toTenths(30 * TEMP_ONE));
+    TEST_ASSERT_EQUAL_INT(-5, utils::toTenths(-TEMP_ONE / 2));
+
+    for(int t = -550; t <= 1250; t++)
+        TEST_ASSERT_EQUAL_INT(t, utils::toTenths(utils::fromTenths(t)));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_print_fixed);
+    RUN_TEST(test_print_tenths);
+    RUN_TEST(test_parse_fixed);
+    RUN_TEST(test_parse_fixed_rejects);
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_tenths_conversions);
+    return UNITY_END();
+}
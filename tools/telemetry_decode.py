@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""Decodes the telemetry stream of the ThermoRegulator into CSV.
+
+The stream is made of COBS encoded frames, each ending with a 0 byte, see
+include/telemetry.h. Reads a capture file, or a serial port when pyserial is
+installed, and writes one CSV line per sample. The replies to the console
+commands, see include/console.h, go to stderr. With --send, the lines of a
+file are sent to the port first:
+
+    python3 tools/telemetry_decode.py capture.bin > run.csv
+    python3 tools/telemetry_decode.py --port /dev/ttyACM0 > run.csv
+    echo "set setpoint 35" > cmd.txt
+    python3 tools/telemetry_decode.py --port /dev/ttyACM0 --send cmd.txt
+"""
+
+import argparse
+import csv
+import struct
+import sys
+
+TEMP_ONE = 128
+POWER_MAX = 10000
+
+SAMPLE_TYPE = 0x01
+TEXT_TYPE = 0x02
+SAMPLE = struct.Struct("<BHIhhhhHHHHHBBH")
+
+COLUMNS = ["time_s", "sequence", "temperature_c", "raw_c", "slope_c_min",
+           "ideal_c", "power_pct", "triac_delay_us", "sync_delay_us",
+           "loop_us", "loop_max_us", "state", "power_state", "drops", "lost"]
+
+
+def cobs_decode(frame):
+    """Returns the content of @frame, without its delimiter, or None if it is
+    malformed."""
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame) + 1:
+            return None
+        out += frame[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+def frames(chunks):
+    """Splits the byte @chunks on the delimiters. What comes before the first
+    delimiter may be a partial frame, it is skipped."""
+    pending = bytearray()
+    synced = False
+    for chunk in chunks:
+        for b in chunk:
+            if b:
+                pending.append(b)
+                continue
+            if synced and pending:
+                yield bytes(pending)
+            pending.clear()
+            synced = True
+
+
+def read_file(f):
+    while True:
+        chunk = f.read(4096)
+        if not chunk:
+            return
+        yield chunk
+
+
+def read_port(port, baud, commands):
+    import serial
+    with serial.Serial(port, baud) as s:
+        for line in commands:
+            s.write(line.strip().encode() + b"\n")
+        while True:
+            yield s.read(max(1, s.in_waiting))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", nargs="?", help="capture file, stdin by default")
+    parser.add_argument("--port", help="serial port to read from instead")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--send", help="file of console commands to send to the port")
+    args = parser.parse_args()
+
+    if args.port:
+        commands = open(args.send).readlines() if args.send else []
+        chunks = read_port(args.port, args.baud, commands)
+    elif args.capture:
+        chunks = read_file(open(args.capture, "rb"))
+    else:
+        chunks = read_file(sys.stdin.buffer)
+
+    out = csv.writer(sys.stdout, lineterminator="\n")
+    out.writerow(COLUMNS)
+
+    last = None
+    bad = 0
+    try:
+        for frame in frames(chunks):
+            data = cobs_decode(frame)
+            if data and data[0] == TEXT_TYPE:
+                print(data[1:].decode("ascii", "replace"), file=sys.stderr)
+                continue
+
+            if not data or data[0] != SAMPLE_TYPE or len(data) != SAMPLE.size:
+                bad += 1
+                continue
+
+            (_, seq, time, temp, raw, slope, ideal, power, delay, sync,
+             loop, loop_max, state, power_state, drops) = SAMPLE.unpack(data)
+
+            # Samples dropped by the firmware or lost on the way
+            lost = (seq - last - 1) & 0xFFFF if last is not None else 0
+            last = seq
+
+            out.writerow([f"{time / 1000:.3f}", seq,
+                          f"{temp / TEMP_ONE:.3f}", f"{raw / TEMP_ONE:.3f}",
+                          f"{slope / TEMP_ONE:.3f}", f"{ideal / 10:.1f}",
+                          f"{power * 100 / POWER_MAX:.2f}", delay, sync,
+                          loop, loop_max, state, power_state, drops, lost])
+            sys.stdout.flush()
+    except KeyboardInterrupt:
+        pass
+
+    if bad:
+        print(f"{bad} malformed frames skipped", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()